@@ -0,0 +1,143 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "cpputils/system.h"
+#include <type_traits>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace rehlds::common
+{
+    namespace detail
+    {
+        template <typename Export, typename... Exports>
+        struct ExportIndex;
+
+        template <typename Export, typename... Exports>
+        struct ExportIndex<Export, Export, Exports...> : std::integral_constant<std::size_t, 0>
+        {
+        };
+
+        template <typename Export, typename Other, typename... Exports>
+        struct ExportIndex<Export, Other, Exports...>
+          : std::integral_constant<std::size_t, 1 + ExportIndex<Export, Exports...>::value>
+        {
+        };
+    }
+
+    /**
+     * @brief Table of the functions exported by a module, resolved once when the module is loaded.
+     *
+     * Each export is declared as a type with the symbol name and the function pointer type:
+     * @code
+     * struct NetSleepTimeout
+     * {
+     *     static constexpr auto* name = "NET_Sleep_Timeout";
+     *     using type = int (*)();
+     * };
+     * @endcode
+     * The resolved pointers are stored in a flat tuple, so \c get() is a plain load of the pointer,
+     * without the \c dlsym() lookup of \c HldsModule::get_proc_address().
+     */
+    template <typename... Exports>
+    class ExportTable
+    {
+      public:
+        /**
+         * @brief Number of the declared exports.
+         */
+        static constexpr std::size_t size = sizeof...(Exports);
+
+        /**
+         * @brief Resolves all exports from the module.
+         *
+         * @return \c true if every export was found, otherwise \c false
+         */
+        template <typename Handle>
+        bool resolve(Handle&& module) noexcept;
+
+        /**
+         * @brief Resets all exports to \c nullptr, before the module is unloaded.
+         */
+        void clear() noexcept;
+
+        /**
+         * @brief Returns the resolved export, \c nullptr if the module does not export it.
+         */
+        template <typename Export>
+        [[nodiscard]] typename Export::type get() const noexcept;
+
+        /**
+         * @brief Returns the number of the exports the module does not export.
+         */
+        [[nodiscard]] std::size_t missing() const noexcept;
+
+        /**
+         * @brief Calls the function with the name of each export the module does not export.
+         */
+        template <typename Fn>
+        void for_each_missing(Fn&& fn) const;
+
+      private:
+        /* Resolved exports, in the declaration order. */
+        std::tuple<typename Exports::type...> exports_{};
+
+        /* Returns the resolved state of each export. */
+        [[nodiscard]] std::array<bool, size> resolved() const noexcept;
+    };
+
+    template <typename... Exports>
+    template <typename Handle>
+    bool ExportTable<Exports...>::resolve(Handle&& module) noexcept
+    {
+        exports_ = {cpputils::get_proc_address<typename Exports::type>(module, Exports::name)...};
+        return 0 == missing();
+    }
+
+    template <typename... Exports>
+    void ExportTable<Exports...>::clear() noexcept
+    {
+        exports_ = {};
+    }
+
+    template <typename... Exports>
+    template <typename Export>
+    typename Export::type ExportTable<Exports...>::get() const noexcept
+    {
+        return std::get<detail::ExportIndex<Export, Exports...>::value>(exports_);
+    }
+
+    template <typename... Exports>
+    std::size_t ExportTable<Exports...>::missing() const noexcept
+    {
+        const auto states = resolved();
+        return static_cast<std::size_t>(std::count(states.cbegin(), states.cend(), false));
+    }
+
+    template <typename... Exports>
+    template <typename Fn>
+    void ExportTable<Exports...>::for_each_missing(Fn&& fn) const
+    {
+        constexpr std::array<const char*, size> names{Exports::name...};
+        const auto states = resolved();
+
+        for (std::size_t i = 0; i < size; ++i) {
+            if (!states[i]) {
+                fn(names[i]);
+            }
+        }
+    }
+
+    template <typename... Exports>
+    std::array<bool, ExportTable<Exports...>::size> ExportTable<Exports...>::resolved() const noexcept
+    {
+        return std::apply([](const auto... exports) { return std::array<bool, size>{(nullptr != exports)...}; },
+          exports_);
+    }
+}
@@ -4,15 +4,21 @@
 
 #pragma once
 
+#include "common/export_table.h"
 #include "common/interface.h"
 #include "common/interfaces/system_base.h"
 #include "cpputils/singleton_holder.h"
 #include "cpputils/system.h"
+#include "cpputils/trace.h"
 #include <unordered_map>
 #include <cassert>
 #include <string>
 #include <utility>
 
+#ifndef _WIN32
+  #include <link.h>
+#endif
+
 namespace rehlds::common
 {
 #ifdef _WIN32
@@ -57,11 +63,30 @@ namespace rehlds::common
          */
         bool load();
 
+#ifndef _WIN32
+        /**
+         * @brief Loads a DLL/component from disk into a link-map namespace.
+         *
+         * @param link_map Namespace to load the module into, \c LM_ID_NEWLM for a new one.
+         * Receives the identifier of the created namespace.
+         *
+         * @return \c true if loaded successfully, otherwise \c false
+         */
+        bool load(::Lmid_t& link_map);
+#endif
+
         /**
          * @brief Unloads a DLL/component.
          */
         void unload() noexcept;
 
+#ifndef _WIN32
+        /**
+         * @brief Returns true if the address belongs to the module, in the namespace it was loaded into.
+         */
+        [[nodiscard]] bool contains(const void* address) const noexcept;
+#endif
+
         /**
          *  @brief Returns a pointer to a CreateInterface function.
          */
@@ -89,6 +114,26 @@ namespace rehlds::common
         template <typename T>
         [[nodiscard]] T* get_interface(const std::string& name, bool cache = true);
 
+      protected:
+        /**
+         * @brief Resolves the exports cached by the module wrapper, after the module was loaded.
+         */
+        virtual void resolve_exports()
+        {
+        }
+
+        /**
+         * @brief Resets the exports cached by the module wrapper, after the module was unloaded.
+         */
+        virtual void clear_exports() noexcept
+        {
+        }
+
+        /**
+         * @brief Returns the module handle, \c nullptr if the module is not loaded.
+         */
+        [[nodiscard]] cpputils::SysModule* handle() const noexcept;
+
       private:
         /* Finds an interface in the cache. */
         [[nodiscard]] IBaseInterface* find_interface(const std::string& name) const;
@@ -128,19 +173,62 @@ namespace rehlds::common
         }
 
         interfaces_.clear();
+        const cpputils::TraceSpan span{"dlopen", "module", name_};
         handle_ = cpputils::load_module(name_.c_str());
 
+        if (is_loaded()) {
+            resolve_exports();
+        }
+
+        return is_loaded();
+    }
+
+#ifndef _WIN32
+    inline bool HldsModule::load(::Lmid_t& link_map)
+    {
+        if (is_loaded()) {
+            return true;
+        }
+
+        interfaces_.clear();
+        const cpputils::TraceSpan span{"dlmopen", "module", name_};
+        handle_ = cpputils::load_module(name_.c_str(), link_map);
+
+        if (is_loaded()) {
+            resolve_exports();
+        }
+
         return is_loaded();
     }
+#endif
 
     inline void HldsModule::unload() noexcept
     {
         if (is_loaded() && unload_module(handle_)) {
             interfaces_.clear();
+            clear_exports();
             handle_ = nullptr;
         }
     }
 
+#ifndef _WIN32
+    inline bool HldsModule::contains(const void* const address) const noexcept
+    {
+        ::Dl_info info{};
+        ::link_map* address_map = nullptr;
+        ::link_map* module_map = nullptr;
+
+        return is_loaded() &&
+               (0 != ::dladdr1(address, &info, reinterpret_cast<void**>(&address_map), RTLD_DL_LINKMAP)) &&
+               (0 == ::dlinfo(handle_, RTLD_DI_LINKMAP, &module_map)) && (address_map == module_map);
+    }
+#endif
+
+    inline cpputils::SysModule* HldsModule::handle() const noexcept
+    {
+        return handle_;
+    }
+
     inline CreateInterfaceFn HldsModule::get_factory() noexcept
     {
         return get_proc_address<CreateInterfaceFn>(CREATE_INTERFACE_PROC_NAME);
@@ -169,6 +257,7 @@ namespace rehlds::common
             *status = CreateInterfaceStatus::failed;
         }
 
+        const cpputils::TraceSpan span{"get_interface", "module", name};
         auto* const factory = get_factory();
         interface = nullptr == factory ? nullptr : static_cast<T*>(factory(name.c_str(), status));
 
@@ -201,17 +290,59 @@ namespace rehlds::common
         interfaces_[name] = interface;
     }
 
+    /**
+     * @brief Engine export called by the \c -pingboost 3 sleep.
+     */
+    struct NetSleepTimeoutExport
+    {
+        static constexpr auto* name = "NET_Sleep_Timeout";
+        using type = int (*)();
+    };
+
+    /**
+     * @brief Engine exports the launcher calls directly.
+     */
+    using EngineExports = ExportTable<NetSleepTimeoutExport>;
+
     class HldsEngineModule : public HldsModule
     {
       public:
         explicit HldsEngineModule(std::string name);
         ISystemBase* get_system();
+
+        /**
+         * @brief Returns the engine exports, resolved when the module was loaded.
+         */
+        [[nodiscard]] const EngineExports& exports() const noexcept;
+
+      protected:
+        void resolve_exports() override;
+        void clear_exports() noexcept override;
+
+      private:
+        /* Engine exports. */
+        EngineExports exports_{};
     };
 
     inline HldsEngineModule::HldsEngineModule(std::string name) : HldsModule(std::move(name))
     {
     }
 
+    inline const EngineExports& HldsEngineModule::exports() const noexcept
+    {
+        return exports_;
+    }
+
+    inline void HldsEngineModule::resolve_exports()
+    {
+        exports_.resolve(handle());
+    }
+
+    inline void HldsEngineModule::clear_exports() noexcept
+    {
+        exports_.clear();
+    }
+
     inline ISystemBase* HldsEngineModule::get_system()
     {
         auto* const system_module = get_interface<ISystemModule>(INTERFACE_SYSTEM_BASE);
@@ -6,10 +6,12 @@
 
 #include "common/interface.h"
 #include "common/platform.h"
+#include <cstdint>
 
 namespace rehlds::common
 {
     constexpr auto* INTERFACE_DEDICATED_SERVER_API = "VENGINE_HLDS_API_VERSION002";
+    constexpr auto* INTERFACE_DEDICATED_SERVER_API_EX = "VENGINE_HLDS_API_VERSION003";
 
     /**
      * @brief This is the interface exported by the engine to allow a dedicated server front end application to host it.
@@ -43,4 +45,34 @@ namespace rehlds::common
          */
         virtual void update_status(float* fps, int* active_players, int* max_players, char* current_map) = 0;
     };
+
+    /**
+     * @brief Frame scheduling state reported by the engine through \c IDedicatedServerApiEx.
+     */
+    struct EngineFrameState
+    {
+        /* Time left until the engine's next frame is due, in nanoseconds; zero or negative if it is due already. */
+        std::int64_t next_frame_delay;
+
+        /* Non-zero if network input is waiting to be read by the engine. */
+        int network_pending;
+    };
+
+    /**
+     * @brief Optional extension of \c IDedicatedServerApi, exposed by the engines that can report when they need
+     * the next frame.
+     *
+     * The functions are appended to \c IDedicatedServerApi, so the engine exposes the same object under both
+     * version names and the launcher keeps using \c VENGINE_HLDS_API_VERSION002 when this one is not found.
+     */
+    class NO_VTABLE IDedicatedServerApiEx : public IDedicatedServerApi
+    {
+      public:
+        /**
+         * @brief Get the time left until the next frame and whether network input is pending.
+         *
+         * The delay is relative to the call, so the engine and the launcher do not need to share a clock.
+         */
+        virtual void get_frame_state(EngineFrameState* state) = 0;
+    };
 }
@@ -0,0 +1,86 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "common/export_table.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <dlfcn.h>
+#include <string>
+#include <vector>
+
+namespace rehlds::common::test
+{
+    struct StrlenExport
+    {
+        static constexpr auto* name = "strlen";
+        using type = std::size_t (*)(const char*);
+    };
+
+    struct AbsExport
+    {
+        static constexpr auto* name = "abs";
+        using type = int (*)(int);
+    };
+
+    struct MissingExport
+    {
+        static constexpr auto* name = "rehlds_missing_export";
+        using type = void (*)();
+    };
+
+    namespace
+    {
+        /* Opens the C library, whose exports the tables resolve. */
+        [[nodiscard]] void* open_libc()
+        {
+            return ::dlopen("libc.so.6", RTLD_NOW);
+        }
+    }
+
+    TEST(ExportTable, ResolvesTypedExports)
+    {
+        auto* const handle = open_libc();
+        ASSERT_NE(nullptr, handle);
+
+        ExportTable<StrlenExport, AbsExport> exports{};
+        ASSERT_TRUE(exports.resolve(handle));
+        ASSERT_EQ(0, exports.missing());
+
+        ASSERT_EQ(6, exports.get<StrlenExport>()("rehlds"));
+        ASSERT_EQ(3, exports.get<AbsExport>()(-3));
+        ::dlclose(handle);
+    }
+
+    TEST(ExportTable, ReportsMissingExports)
+    {
+        auto* const handle = open_libc();
+        ASSERT_NE(nullptr, handle);
+
+        ExportTable<StrlenExport, MissingExport, AbsExport> exports{};
+        ASSERT_FALSE(exports.resolve(handle));
+        ASSERT_EQ(1, exports.missing());
+        ASSERT_NE(nullptr, exports.get<StrlenExport>());
+        ASSERT_EQ(nullptr, exports.get<MissingExport>());
+        ASSERT_NE(nullptr, exports.get<AbsExport>());
+
+        std::vector<std::string> missing{};
+        exports.for_each_missing([&missing](const char* const name) { missing.emplace_back(name); });
+        ASSERT_EQ(std::vector<std::string>{MissingExport::name}, missing);
+        ::dlclose(handle);
+    }
+
+    TEST(ExportTable, Clear)
+    {
+        auto* const handle = open_libc();
+        ASSERT_NE(nullptr, handle);
+
+        ExportTable<StrlenExport, AbsExport> exports{};
+        exports.resolve(handle);
+        exports.clear();
+        ::dlclose(handle);
+
+        ASSERT_EQ(2, exports.missing());
+        ASSERT_EQ(nullptr, exports.get<StrlenExport>());
+    }
+}
@@ -3,14 +3,28 @@
  */
 
 #include "arguments.h"
+#include "clock.h"
 #include "common/hlds_module.h"
+#include "console/console_log.h"
+#include "console/output_writer.h"
 #include "console/text_console.h"
+#include "cpputils/string.h"
 #include "cpputils/system.h"
 #include "sleep.h"
+
+#ifndef _WIN32
+  #include "huge_pages.h"
+  #include "realtime.h"
+  #include "status_publisher.h"
+#endif
+#include <chrono>
 #include <csignal>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <limits>
+#include <memory>
 #include <string>
 
 using namespace rehlds::common;
@@ -56,11 +70,266 @@ namespace
         }
     }
 
+#ifndef _WIN32
+    void configure_frame_pacer(const CommandLine& cmdline)
+    {
+        std::int64_t margin = 0;
+
+        if (std::string pacer_margin{}; cmdline.find_param("-pacermargin", pacer_margin) && (!pacer_margin.empty())) {
+            margin = std::strtoll(pacer_margin.c_str(), nullptr, 10) * NANOSECONDS_PER_MICROSECOND;
+        }
+
+        auto& pacer = get_frame_pacer();
+        pacer.configure(frame_rate(cmdline), margin);
+
+        TextConsole::print("Frame pacer: period {:.3f} ms, spin margin {:.3f} ms.\n", to_milliseconds(pacer.period()),
+          to_milliseconds(pacer.margin()));
+    }
+
+    [[nodiscard]] bool start_frame_timer(const CommandLine& cmdline)
+    {
+        auto& timer = get_frame_timer();
+
+        if (!timer.start(frame_rate(cmdline))) {
+            TextConsole::print("WARNING! -pingboost 7: Failed to create frame timer ({}).\n",
+              cpputils::get_last_error_str());
+            return false;
+        }
+
+        TextConsole::print("Frame timer: period {:.3f} ms.\n", to_milliseconds(timer.period()));
+        return true;
+    }
+#endif
+
+    void cpuaffinity(const CommandLine& cmdline)
+    {
+        if (std::string cpus{}; cmdline.find_param("-cpuaffinity", cpus) && (!cpus.empty())) {
+#ifdef _WIN32
+            TextConsole::print("WARNING! -cpuaffinity: Not supported on this platform.\n");
+#else
+            if (!set_thread_affinity(cpus)) {
+                TextConsole::print("WARNING! -cpuaffinity {}: {}.\n", cpus, cpputils::get_last_error_str());
+            }
+
+            TextConsole::print("Server thread CPU affinity: {}\n", get_thread_affinity());
+#endif
+        }
+    }
+
+    void schedpolicy(const CommandLine& cmdline)
+    {
+        if (std::string policy{}; cmdline.find_param("-schedpolicy", policy) && (!policy.empty())) {
+#ifdef _WIN32
+            TextConsole::print("WARNING! -schedpolicy: Not supported on this platform.\n");
+#else
+            auto priority = 1;
+
+            if (std::string value{}; cmdline.find_param("-schedpriority", value) && (!value.empty())) {
+                priority = static_cast<int>(std::strtol(value.c_str(), nullptr, 10));
+            }
+
+            if (!set_thread_scheduler(policy, priority)) {
+                TextConsole::print("WARNING! -schedpolicy {} -schedpriority {}: {}.\n", policy, priority,
+                  cpputils::get_last_error_str());
+            }
+
+            TextConsole::print("Server thread scheduler: {}\n", get_thread_scheduler());
+#endif
+        }
+    }
+
+    void memlock(const CommandLine& cmdline)
+    {
+        if (cmdline.find_param("-mlockall")) {
+#ifdef _WIN32
+            TextConsole::print("WARNING! -mlockall: Not supported on this platform.\n");
+#else
+            if (lock_memory()) {
+                TextConsole::print("Process memory locked.\n");
+            }
+            else {
+                TextConsole::print("WARNING! -mlockall: {}.\n", cpputils::get_last_error_str());
+            }
+#endif
+        }
+    }
+
+#ifndef _WIN32
+    void remap_text(const std::string& module_file)
+    {
+        HugePageText text{};
+
+        if (!remap_text_to_huge_pages(module_file, text)) {
+            TextConsole::print("WARNING! -hugepagetext: Unable to remap {}: {}.\n", module_file,
+              cpputils::get_last_error_str());
+        }
+        else if (0 == text.remapped_size) {
+            TextConsole::print("Huge page text: {} text ({} KB) spans no whole huge page.\n", module_file,
+              text.text_size / 1024);
+        }
+        else {
+            TextConsole::print("Huge page text: {}: {} KB of {} KB text remapped, {} huge pages.\n", module_file,
+              text.remapped_size / 1024, text.text_size / 1024, text.huge_pages);
+        }
+    }
+#endif
+
+    void hugepagetext(const CommandLine& cmdline)
+    {
+        if (!cmdline.find_param("-hugepagetext")) {
+            return;
+        }
+
+#ifdef _WIN32
+        TextConsole::print("WARNING! -hugepagetext: Not supported on this platform.\n");
+#else
+        if (!huge_pages_available()) {
+            TextConsole::print("WARNING! -hugepagetext: Transparent huge pages are disabled.\n");
+            return;
+        }
+
+        // The modules of hosted servers live in their own namespaces and are not remapped
+        if (get_engine_module().is_loaded()) {
+            remap_text(ENGINE_MODULE_FILE);
+        }
+#endif
+    }
+
+    void hugepagetextgame([[maybe_unused]] const CommandLine& cmdline)
+    {
+#ifndef _WIN32
+        if ((!cmdline.find_param("-hugepagetext")) || (!huge_pages_available())) {
+            return;
+        }
+
+        // The engine loads the game module during its initialization
+        if (const auto path = game_module_path(cmdline); !path.empty()) {
+            remap_text(std::filesystem::path{path}.filename().string());
+        }
+#endif
+    }
+
+    void asyncoutput(const CommandLine& cmdline)
+    {
+        if (cmdline.find_param("-syncoutput")) {
+            return;
+        }
+
+        constexpr std::size_t kilobyte = 1024;
+        std::size_t size = 1024;
+
+        if (std::string value{}; cmdline.find_param("-outputbuffer", value) && (!value.empty())) {
+            size = std::max(std::strtoul(value.c_str(), nullptr, 10), 64UL);
+        }
+
+        get_output_writer().start(std::make_unique<StandardOutputSink>(), size * kilobyte);
+    }
+
+    void conlog(const CommandLine& cmdline)
+    {
+        std::string path{};
+
+        if ((!cmdline.find_param("-conlog", path)) || path.empty()) {
+            return;
+        }
+
+        ConsoleLogOptions options{};
+        options.path = path;
+
+        constexpr std::uint64_t megabyte = 1024 * 1024;
+        options.max_size = 64 * megabyte;
+
+        if (std::string value{}; cmdline.find_param("-conlogsize", value) && (!value.empty())) {
+            options.max_size = std::strtoull(value.c_str(), nullptr, 10) * megabyte;
+        }
+
+        if (std::string value{}; cmdline.find_param("-conlogtime", value) && (!value.empty())) {
+            options.max_age = std::chrono::minutes{std::strtol(value.c_str(), nullptr, 10)};
+        }
+
+        options.compress = cmdline.find_param("-conlogcompress");
+#ifdef _WIN32
+        if (options.compress) {
+            TextConsole::print("WARNING! -conlogcompress: Not supported on this platform.\n");
+            options.compress = false;
+        }
+#endif
+        if (!get_console_log().open(options)) {
+            TextConsole::print("WARNING! -conlog {}: Unable to open the log file.\n", options.path.string());
+        }
+    }
+
+    void statuspage(const CommandLine& cmdline)
+    {
+        std::string name{};
+
+        if (!cmdline.find_param("-statuspage", name)) {
+            return;
+        }
+
+#ifdef _WIN32
+        TextConsole::print("WARNING! -statuspage: Not supported on this platform.\n");
+#else
+        if (name.empty()) {
+            std::string port{};
+
+            if ((!cmdline.find_param("\\+port", port)) || port.empty()) {
+                port = "27015";
+            }
+
+            name = STATUS_PAGE_PREFIX + port;
+        }
+
+        if (get_status_publisher().open(name)) {
+            TextConsole::print("Status page: /dev/shm/{}\n", name);
+        }
+        else {
+            TextConsole::print("WARNING! -statuspage {}: {}.\n", name, cpputils::get_last_error_str());
+        }
+#endif
+    }
+
+    void nomallocmmap(const CommandLine& cmdline)
+    {
+        if (cmdline.find_param("-nomallocmmap")) {
+#ifdef _WIN32
+            TextConsole::print("WARNING! -nomallocmmap: Not supported on this platform.\n");
+#else
+            if (!disable_heap_mappings()) {
+                TextConsole::print("WARNING! -nomallocmmap: Failed to change the malloc settings.\n");
+            }
+#endif
+        }
+    }
+
+    void prefaultheap([[maybe_unused]] const CommandLine& cmdline)
+    {
+#ifndef _WIN32
+        constexpr std::size_t megabyte = 1024 * 1024;
+        constexpr std::size_t default_size = 64;
+        auto size = cmdline.find_param("-mlockall") ? default_size : 0;
+
+        if (std::string value{}; cmdline.find_param("-prefaultheap", value) && (!value.empty())) {
+            size = std::strtoul(value.c_str(), nullptr, 10);
+        }
+
+        if (size > std::numeric_limits<std::size_t>::max() / megabyte) {
+            TextConsole::print("WARNING! -prefaultheap {}: The size is too large.\n", size);
+        }
+        else if (size > 0) {
+            prefault_memory(size * megabyte);
+            TextConsole::print("Prefaulted {} MB of heap.\n", size);
+        }
+#endif
+    }
+
     void pingboost(const CommandLine& cmdline)
     {
         auto& engine_module = get_engine_module();
         sys_sleep = &sleep_thread_millisecond;
-        net_sleep = engine_module.get_proc_address<NetSleep>("NET_Sleep_Timeout");
+        sleep_duration = NANOSECONDS_PER_MILLISECOND;
+        net_sleep = engine_module.exports().get<NetSleepTimeoutExport>();
+        sleep_adaptive = cmdline.find_param("-adaptivesleep");
 
         if (std::string ping_boost{}; cmdline.find_param("-pingboost", ping_boost) && (!ping_boost.empty())) {
             switch (std::strtol(ping_boost.c_str(), nullptr, 10)) {
@@ -68,6 +337,7 @@ namespace
                 case 4: {
                     cpputils::set_timer_resolution(1);
                     sys_sleep = &sleep_delay_execution;
+                    sleep_duration = 100;
                     break;
                 }
 #else
@@ -82,15 +352,39 @@ namespace
                 }
                 case 4: {
                     sys_sleep = &sleep_thread_microsecond;
+                    sleep_duration = 3 * NANOSECONDS_PER_MICROSECOND;
+                    break;
+                }
+                case 6: {
+                    configure_frame_pacer(cmdline);
+                    sys_sleep = &sleep_pacer;
+                    sleep_adaptive = false;
+                    sleep_duration = 0;
+                    break;
+                }
+                case 7: {
+                    if (start_frame_timer(cmdline)) {
+                        sys_sleep = &sleep_frame_timer;
+                        sleep_duration = 0;
+                    }
+                    else {
+                        std::signal(SIGALRM, &sigalrm_handler);
+                        sys_sleep = &sleep_timer;
+                    }
+
+                    sleep_adaptive = false;
                     break;
                 }
 #endif
                 case 3: {
                     sys_sleep = &sleep_net;
+                    sleep_adaptive = false;
                     break;
                 }
                 case 5: {
                     sys_sleep = &thread_yield;
+                    sleep_adaptive = false;
+                    sleep_duration = 0;
                     break;
                 }
                 default: {
@@ -110,5 +404,69 @@ namespace rehlds::dedicated
         ignoresigint(cmdline);
         pidfile(cmdline);
         pingboost(cmdline);
+        cpuaffinity(cmdline);
+        schedpolicy(cmdline);
+        hugepagetext(cmdline);
+        memlock(cmdline);
+        nomallocmmap(cmdline);
+        asyncoutput(cmdline);
+        conlog(cmdline);
+        statuspage(cmdline);
+    }
+
+    void process_engine_arguments(const CommandLine& cmdline)
+    {
+        pingboost(cmdline);
+        hugepagetext(cmdline);
     }
+
+    void process_post_init_arguments(const CommandLine& cmdline)
+    {
+        hugepagetextgame(cmdline);
+        prefaultheap(cmdline);
+    }
+
+#ifndef _WIN32
+    double frame_rate(const CommandLine& cmdline)
+    {
+        constexpr auto default_rate = 1000.0;
+
+        if (std::string tic_rate{}; cmdline.find_param("\\+sys_ticrate", tic_rate) && (!tic_rate.empty())) {
+            if (const auto rate = std::strtod(tic_rate.c_str(), nullptr); rate > 0.0) {
+                return rate;
+            }
+        }
+
+        return default_rate;
+    }
+
+    std::string game_module_path(const CommandLine& cmdline)
+    {
+        std::string game{};
+
+        if ((!cmdline.find_param("-game", game)) || game.empty()) {
+            game = "valve";
+        }
+
+        std::ifstream file{game + "/liblist.gam"};
+        std::string line{};
+
+        while (std::getline(file, line)) {
+            line = cpputils::trim(line);
+
+            if (0 != line.rfind("gamedll_linux", 0)) {
+                continue;
+            }
+
+            const auto begin = line.find('"');
+            const auto end = line.find('"', begin + 1);
+
+            if ((std::string::npos != begin) && (std::string::npos != end)) {
+                return game + '/' + line.substr(begin + 1, end - begin - 1);
+            }
+        }
+
+        return {};
+    }
+#endif
 }
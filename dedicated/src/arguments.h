@@ -5,8 +5,32 @@
 #pragma once
 
 #include "command_line.h"
+#include <string>
 
 namespace rehlds::dedicated
 {
     void process_cmdline_arguments(const CommandLine& cmdline);
+
+    /**
+     * @brief Applies the arguments bound to the loaded engine module again, after the module was reloaded.
+     */
+    void process_engine_arguments(const CommandLine& cmdline);
+
+    /**
+     * @brief Applies the arguments that require an initialized engine.
+     */
+    void process_post_init_arguments(const CommandLine& cmdline);
+
+#ifndef _WIN32
+    /**
+     * @brief Returns the server frame rate requested with \c +sys_ticrate.
+     */
+    [[nodiscard]] double frame_rate(const CommandLine& cmdline);
+
+    /**
+     * @brief Returns the path of the game module declared by \c gamedll_linux in the \c liblist.gam
+     * of the \c -game directory, or an empty string if there is none.
+     */
+    [[nodiscard]] std::string game_module_path(const CommandLine& cmdline);
+#endif
 }
@@ -0,0 +1,53 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#ifndef _WIN32
+  #include <ctime>
+#endif
+
+namespace rehlds::dedicated
+{
+    constexpr std::int64_t NANOSECONDS_PER_MICROSECOND = 1'000;
+    constexpr std::int64_t NANOSECONDS_PER_MILLISECOND = 1'000'000;
+    constexpr std::int64_t NANOSECONDS_PER_SECOND = 1'000'000'000;
+
+    /**
+     * @brief Returns the current time of the monotonic clock, in nanoseconds.
+     *
+     * @note On Linux the steady clock is \c CLOCK_MONOTONIC, so the returned value can be used
+     * as an absolute deadline for \c clock_nanosleep() and \c timerfd_settime().
+     */
+    [[nodiscard]] inline std::int64_t clock_now() noexcept
+    {
+        const auto time = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    }
+
+    /**
+     * @brief Converts nanoseconds to milliseconds.
+     */
+    [[nodiscard]] constexpr double to_milliseconds(const std::int64_t nanoseconds) noexcept
+    {
+        return static_cast<double>(nanoseconds) / static_cast<double>(NANOSECONDS_PER_MILLISECOND);
+    }
+
+#ifndef _WIN32
+    /**
+     * @brief Converts nanoseconds to the \c timespec structure.
+     */
+    [[nodiscard]] constexpr ::timespec to_timespec(const std::int64_t nanoseconds) noexcept
+    {
+        ::timespec time{};
+        time.tv_sec = static_cast<::time_t>(nanoseconds / NANOSECONDS_PER_SECOND);
+        time.tv_nsec = static_cast<long>(nanoseconds % NANOSECONDS_PER_SECOND);
+
+        return time;
+    }
+#endif
+}
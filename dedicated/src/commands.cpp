@@ -0,0 +1,83 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "commands.h"
+#include "console/text_console.h"
+#include "cpputils/string.h"
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+using namespace rehlds::dedicated;
+
+namespace
+{
+    struct Command
+    {
+        std::string name;
+        std::string description;
+        CommandHandler handler;
+    };
+
+    std::vector<Command> commands{};
+
+    void help_command(const std::string& /* unused */)
+    {
+        for (const auto& [name, description, handler] : commands) {
+            TextConsole::print("{:<20} {}\n", name, description);
+        }
+    }
+}
+
+namespace rehlds::dedicated
+{
+    void add_command(std::string name, std::string description, const CommandHandler handler)
+    {
+        assert(!name.empty());
+        assert(handler != nullptr);
+
+        if (commands.empty()) {
+            commands.push_back({"hlds_help", "List the launcher console commands.", &help_command});
+        }
+
+        const auto& it = std::find_if(commands.cbegin(), commands.cend(),
+          [&name](const Command& command)
+          {
+              return cpputils::equal_ignore_case(command.name, name);
+          });
+
+        if (commands.cend() == it) {
+            commands.push_back({std::move(name), std::move(description), handler});
+        }
+    }
+
+    bool execute_command(const std::string& text)
+    {
+        const auto name_end = text.find_first_of(" \t");
+        const auto name = text.substr(0, name_end);
+
+        for (const auto& command : commands) {
+            if (cpputils::equal_ignore_case(command.name, name)) {
+                const auto args = std::string::npos == name_end ? std::string{} : text.substr(name_end);
+                command.handler(cpputils::trim(args));
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::vector<std::string> get_command_names()
+    {
+        std::vector<std::string> names{};
+        names.reserve(commands.size());
+
+        for (const auto& command : commands) {
+            names.push_back(command.name);
+        }
+
+        return names;
+    }
+}
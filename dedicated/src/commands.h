@@ -0,0 +1,35 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Launcher console command handler.
+     *
+     * @param args Command arguments, trimmed.
+     */
+    using CommandHandler = void (*)(const std::string& args);
+
+    /**
+     * @brief Registers a console command that is handled by the launcher instead of the engine.
+     */
+    void add_command(std::string name, std::string description, CommandHandler handler);
+
+    /**
+     * @brief Executes the console line if it starts with a launcher command.
+     *
+     * @return \c true if the line was handled by the launcher, otherwise \c false
+     */
+    bool execute_command(const std::string& text);
+
+    /**
+     * @brief Returns the names of the registered launcher commands.
+     */
+    [[nodiscard]] std::vector<std::string> get_command_names();
+}
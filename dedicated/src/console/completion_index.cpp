@@ -0,0 +1,85 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "console/completion_index.h"
+#include "cpputils/string.h"
+#include <algorithm>
+#include <utility>
+
+namespace rehlds::dedicated
+{
+    void CompletionIndex::rebuild(std::vector<std::string> names, const bool complete)
+    {
+        for (auto& name : names) {
+            name = cpputils::lower(name);
+        }
+
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+
+        {
+            const std::lock_guard lock{mutex_};
+            names_ = std::move(names);
+        }
+
+        rebuild_time_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        stale_.store(!complete, std::memory_order_release);
+    }
+
+    CompletionMatches CompletionIndex::find(const std::string_view prefix) const
+    {
+        const auto key = cpputils::lower(prefix);
+        const auto starts_with_key = [&key](const std::string& name)
+        {
+            return 0 == name.compare(0, key.length(), key);
+        };
+
+        CompletionMatches matches{};
+        const std::lock_guard lock{mutex_};
+
+        const auto first = std::lower_bound(names_.cbegin(), names_.cend(), key);
+        const auto last = std::find_if_not(first, names_.cend(), starts_with_key);
+
+        if (first == last) {
+            return matches;
+        }
+
+        matches.names.assign(first, last);
+
+        // In a sorted range the prefix shared by all names is the one shared by the first and the last
+        const auto& front = matches.names.front();
+        const auto& back = matches.names.back();
+        const auto length = std::min(front.length(), back.length());
+        const auto mismatch = std::mismatch(front.cbegin(), front.cbegin() + static_cast<std::ptrdiff_t>(length),
+          back.cbegin());
+
+        matches.common_prefix.assign(front.cbegin(), mismatch.first);
+
+        for (const auto& name : matches.names) {
+            matches.longest_length = std::max(matches.longest_length, name.length());
+        }
+
+        return matches;
+    }
+
+    bool CompletionIndex::needs_rebuild(const bool miss) const noexcept
+    {
+        if (stale_.load(std::memory_order_acquire)) {
+            return true;
+        }
+
+        if (!miss) {
+            return false;
+        }
+
+        const std::chrono::steady_clock::duration last_rebuild{rebuild_time_.load(std::memory_order_relaxed)};
+        return (std::chrono::steady_clock::now().time_since_epoch() - last_rebuild) >= MISS_REFRESH_INTERVAL;
+    }
+
+    std::size_t CompletionIndex::size() const
+    {
+        const std::lock_guard lock{mutex_};
+        return names_.size();
+    }
+}
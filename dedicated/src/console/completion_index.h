@@ -0,0 +1,95 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Console command and variable names that start with a prefix.
+     */
+    struct CompletionMatches
+    {
+        /* Matching names, lower case and sorted. */
+        std::vector<std::string> names{};
+
+        /* Longest prefix shared by all matching names. */
+        std::string common_prefix{};
+
+        /* Length of the longest matching name, used for the column layout. */
+        std::size_t longest_length{};
+    };
+
+    /**
+     * @brief Sorted index of the console command and variable names used for tab completion.
+     *
+     * The names are fetched from the engine once and looked up with a binary search, so a completion
+     * does not call back into the engine. The index is rebuilt when it is invalidated (e.g. on a map
+     * change, when plugins register new commands) or, rate-limited, when a lookup finds nothing.
+     * Lookups and rebuilds may run on different threads.
+     */
+    class CompletionIndex
+    {
+      public:
+        /* Minimum time between the rebuilds caused by the lookups that found nothing. */
+        static constexpr std::chrono::seconds MISS_REFRESH_INTERVAL{1};
+
+        /**
+         * @brief Replaces the indexed names.
+         *
+         * @param names Command and variable names, in any case and order, possibly with duplicates.
+         * @param complete \c false if the names are only a part of the registered ones and the index
+         * should be rebuilt on the next lookup.
+         */
+        void rebuild(std::vector<std::string> names, bool complete = true);
+
+        /**
+         * @brief Returns the indexed names that start with the specified prefix, ignoring case.
+         */
+        [[nodiscard]] CompletionMatches find(std::string_view prefix) const;
+
+        /**
+         * @brief Marks the index as outdated.
+         */
+        void invalidate() noexcept;
+
+        /**
+         * @brief Returns true if the index should be rebuilt before serving a lookup.
+         *
+         * @param miss \c true if the last lookup found nothing.
+         */
+        [[nodiscard]] bool needs_rebuild(bool miss) const noexcept;
+
+        /**
+         * @brief Returns the number of indexed names.
+         */
+        [[nodiscard]] std::size_t size() const;
+
+      private:
+        /* Guards the names. */
+        mutable std::mutex mutex_{};
+
+        /* Lower case names, sorted and unique. */
+        std::vector<std::string> names_{};
+
+        /* Is the index outdated? */
+        std::atomic<bool> stale_{true};
+
+        /* Time of the last rebuild. */
+        std::atomic<std::chrono::steady_clock::rep> rebuild_time_{};
+    };
+
+    inline void CompletionIndex::invalidate() noexcept
+    {
+        stale_.store(true, std::memory_order_release);
+    }
+}
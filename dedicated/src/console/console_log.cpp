@@ -0,0 +1,268 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "console/console_log.h"
+#include "cpputils/format.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+  #include <sys/types.h>
+  #include <sys/wait.h>
+  #include <csignal>
+  #include <cstdlib>
+  #include <spawn.h>
+  #include <unistd.h>
+
+extern char** environ; // NOLINT(readability-redundant-declaration)
+#endif
+
+namespace
+{
+    using namespace rehlds::dedicated;
+
+    /* Size of the stdio buffer of the log file, a typical batch is written with a single call. */
+    constexpr std::size_t FILE_BUFFER_SIZE = 64 * 1024;
+
+    [[nodiscard]] std::string timestamp(const std::chrono::system_clock::time_point time)
+    {
+        const auto seconds = std::chrono::system_clock::to_time_t(time);
+        std::tm local_time{};
+
+#ifdef _WIN32
+        ::localtime_s(&local_time, &seconds);
+#else
+        ::localtime_r(&seconds, &local_time);
+#endif
+        std::array<char, 32> buffer{};
+        const auto length = std::strftime(buffer.data(), buffer.size(), "%Y%m%d-%H%M%S", &local_time);
+
+        return std::string{buffer.data(), length};
+    }
+
+    [[nodiscard]] std::filesystem::path rotated_path(const std::filesystem::path& path, const std::string& suffix)
+    {
+        auto rotated = path;
+        rotated.replace_filename(cpputils::format("{}-{}{}", path.stem().string(), suffix, path.extension().string()));
+
+        // Several rotations within a second; a path that cannot be checked counts as taken
+        std::error_code error{};
+        const auto taken = [&error](const std::filesystem::path& file)
+        {
+            return std::filesystem::exists(file, error) || error;
+        };
+
+        for (auto i = 1; taken(rotated) || taken(rotated.string() + ".gz"); ++i) {
+            rotated.replace_filename(
+              cpputils::format("{}-{}-{}{}", path.stem().string(), suffix, i, path.extension().string()));
+        }
+
+        return rotated;
+    }
+
+    class RotatingFileSink final : public OutputSink
+    {
+      public:
+        explicit RotatingFileSink(ConsoleLogOptions options) : options_(std::move(options)) {}
+        RotatingFileSink(RotatingFileSink&&) = delete;
+        RotatingFileSink(const RotatingFileSink&) = delete;
+        RotatingFileSink& operator=(RotatingFileSink&&) = delete;
+        RotatingFileSink& operator=(const RotatingFileSink&) = delete;
+        ~RotatingFileSink() override;
+
+        bool open();
+        void write(const OutputSegments& segments) override;
+
+      private:
+        ConsoleLogOptions options_;
+        std::FILE* file_{};
+        std::uint64_t size_{};
+        std::chrono::system_clock::time_point opened_{};
+
+#ifndef _WIN32
+        /* Running compressor processes. */
+        std::vector<::pid_t> compressors_{};
+
+        void compress(const std::filesystem::path& path);
+        void reap_compressors(bool wait);
+#endif
+        [[nodiscard]] bool needs_rotation(std::size_t pending) const;
+        void rotate();
+    };
+
+    RotatingFileSink::~RotatingFileSink()
+    {
+        if (nullptr != file_) {
+            std::fclose(file_);
+        }
+
+#ifndef _WIN32
+        // No compressor is left behind as a zombie
+        reap_compressors(true);
+#endif
+    }
+
+    bool RotatingFileSink::open()
+    {
+        std::error_code error{};
+
+        if (options_.path.has_parent_path()) {
+            std::filesystem::create_directories(options_.path.parent_path(), error);
+        }
+
+        file_ = std::fopen(options_.path.string().c_str(), "ab");
+
+        if (nullptr == file_) {
+            return false;
+        }
+
+        std::setvbuf(file_, nullptr, _IOFBF, FILE_BUFFER_SIZE);
+
+        const auto size = std::filesystem::file_size(options_.path, error);
+        size_ = error ? 0 : size;
+        opened_ = std::chrono::system_clock::now();
+
+        return true;
+    }
+
+    void RotatingFileSink::write(const OutputSegments& segments)
+    {
+        std::size_t pending = 0;
+
+        for (const auto segment : segments) {
+            pending += segment.size();
+        }
+
+        if (needs_rotation(pending)) {
+            rotate();
+        }
+
+        if (nullptr == file_) {
+            return;
+        }
+
+        for (const auto segment : segments) {
+            size_ += std::fwrite(segment.data(), 1, segment.size(), file_);
+        }
+
+        std::fflush(file_);
+
+#ifndef _WIN32
+        reap_compressors(false);
+#endif
+    }
+
+    bool RotatingFileSink::needs_rotation(const std::size_t pending) const
+    {
+        if (0 == size_) {
+            return false;
+        }
+
+        if ((options_.max_size > 0) && ((size_ + pending) > options_.max_size)) {
+            return true;
+        }
+
+        return (options_.max_age.count() > 0) && ((std::chrono::system_clock::now() - opened_) >= options_.max_age);
+    }
+
+    void RotatingFileSink::rotate()
+    {
+        if (nullptr != file_) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+
+        std::error_code error{};
+        const auto rotated = rotated_path(options_.path, timestamp(opened_));
+        std::filesystem::rename(options_.path, rotated, error);
+
+#ifndef _WIN32
+        if ((!error) && options_.compress) {
+            compress(rotated);
+        }
+#endif
+        size_ = 0;
+
+        // If reopening fails, the output is discarded until the next rotation attempt
+        if (!open()) {
+            opened_ = std::chrono::system_clock::now();
+        }
+    }
+
+#ifndef _WIN32
+    void RotatingFileSink::compress(const std::filesystem::path& path)
+    {
+        // The writer thread blocks all signals, the compressor must not inherit that
+        ::posix_spawnattr_t attributes{};
+        ::posix_spawnattr_init(&attributes);
+
+        ::sigset_t signals{};
+        ::sigemptyset(&signals);
+        ::posix_spawnattr_setsigmask(&attributes, &signals);
+        ::posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK);
+
+        // Nor the descriptors of the process opened without O_CLOEXEC, such as the log itself
+        ::posix_spawn_file_actions_t file_actions{};
+        ::posix_spawn_file_actions_init(&file_actions);
+
+        std::error_code error{};
+        std::filesystem::directory_iterator entry{"/proc/self/fd", error};
+
+        for (; (!error) && (entry != std::filesystem::directory_iterator{}); entry.increment(error)) {
+            if (const auto descriptor = std::atoi(entry->path().filename().c_str()); descriptor > STDERR_FILENO) {
+                ::posix_spawn_file_actions_addclose(&file_actions, descriptor);
+            }
+        }
+
+        auto file = path.string();
+        std::array<char*, 5> arguments{const_cast<char*>("gzip"), const_cast<char*>("-f"), const_cast<char*>("-q"),
+          file.data(), nullptr}; // NOLINT(cppcoreguidelines-pro-type-const-cast)
+
+        if (::pid_t pid{}; 0 == ::posix_spawnp(&pid, "gzip", &file_actions, &attributes, arguments.data(), environ)) {
+            compressors_.push_back(pid);
+        }
+
+        ::posix_spawn_file_actions_destroy(&file_actions);
+        ::posix_spawnattr_destroy(&attributes);
+    }
+
+    void RotatingFileSink::reap_compressors(const bool wait)
+    {
+        const auto options = wait ? 0 : WNOHANG;
+
+        compressors_.erase(std::remove_if(compressors_.begin(), compressors_.end(),
+                             [options](const ::pid_t pid) { return 0 != ::waitpid(pid, nullptr, options); }),
+          compressors_.end());
+    }
+#endif
+}
+
+namespace rehlds::dedicated
+{
+    bool ConsoleLog::open(const ConsoleLogOptions& options)
+    {
+        close();
+
+        auto sink = std::make_unique<RotatingFileSink>(options);
+
+        if (!sink->open()) {
+            return false;
+        }
+
+        writer_.start(std::move(sink), options.buffer_size);
+        return true;
+    }
+
+    void ConsoleLog::close()
+    {
+        writer_.stop();
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "console/output_writer.h"
+#include "cpputils/singleton_holder.h"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Console log file settings.
+     */
+    struct ConsoleLogOptions
+    {
+        /* Path of the active log file. */
+        std::filesystem::path path{};
+
+        /* Rotate the file when it grows beyond this size, in bytes; 0 disables the size rotation. */
+        std::uint64_t max_size{};
+
+        /* Rotate the file when it gets older than this; 0 disables the time rotation. */
+        std::chrono::minutes max_age{};
+
+        /* Compress the rotated files with gzip in the background. */
+        bool compress{};
+
+        /* Ring buffer size of the asynchronous writer, in bytes. */
+        std::size_t buffer_size{1024 * 1024};
+    };
+
+    /**
+     * @brief Launcher-owned console log with rotation.
+     *
+     * The console output is queued to an asynchronous \c OutputWriter, whose thread appends it to the
+     * active log file. When the file grows too large or too old, it is renamed to
+     * <tt>name-YYYYMMDD-HHMMSS.ext</tt> and a new file is started; the rotated file is optionally
+     * compressed by a background \c gzip process.
+     */
+    class ConsoleLog
+    {
+      public:
+        ConsoleLog() = default;
+        ConsoleLog(ConsoleLog&&) = delete;
+        ConsoleLog(const ConsoleLog&) = delete;
+        ConsoleLog& operator=(ConsoleLog&&) = delete;
+        ConsoleLog& operator=(const ConsoleLog&) = delete;
+        ~ConsoleLog();
+
+        /**
+         * @brief Opens the log file and starts the writer thread.
+         *
+         * @return \c true if the log file was opened, otherwise \c false
+         */
+        bool open(const ConsoleLogOptions& options);
+
+        /**
+         * @brief Writes out the queued text and closes the log file.
+         */
+        void close();
+
+        /**
+         * @brief Returns true if the log file is open.
+         */
+        [[nodiscard]] bool is_open() const noexcept;
+
+        /**
+         * @brief Queues the text for writing to the log file; does nothing if the log is closed.
+         */
+        void write(std::string_view text);
+
+      private:
+        /* Asynchronous writer, discards the text while the log is closed. */
+        OutputWriter writer_{false};
+    };
+
+    inline ConsoleLog::~ConsoleLog()
+    {
+        close();
+    }
+
+    inline bool ConsoleLog::is_open() const noexcept
+    {
+        return writer_.started();
+    }
+
+    inline void ConsoleLog::write(const std::string_view text)
+    {
+        writer_.write(text);
+    }
+
+    /**
+     * @brief Returns a console log instance.
+     */
+    [[nodiscard]] inline ConsoleLog& get_console_log()
+    {
+        return cpputils::SingletonHolder<ConsoleLog>::get_instance();
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "console/line_renderer.h"
+#include <algorithm>
+#include <cassert>
+
+namespace rehlds::dedicated
+{
+    std::string LineRenderer::update(const std::string_view text, const std::size_t cursor)
+    {
+        assert(cursor <= text.length());
+
+        const auto length = std::min(displayed_.length(), text.length());
+        std::size_t prefix = 0;
+
+        while ((prefix < length) && (text[prefix] == displayed_[prefix])) {
+            ++prefix;
+        }
+
+        std::string output{};
+
+        if ((prefix == text.length()) && (prefix == displayed_.length())) {
+            move_cursor(output, cursor_, cursor);
+        }
+        else {
+            // Redraw the changed tail and erase what is left of the longer old line
+            move_cursor(output, cursor_, prefix);
+            output.append(text.substr(prefix));
+
+            if (text.length() < displayed_.length()) {
+                output.append("\x1B[K");
+            }
+
+            move_cursor(output, text.length(), cursor);
+            displayed_.assign(text);
+        }
+
+        cursor_ = cursor;
+        return output;
+    }
+
+    void LineRenderer::move_cursor(std::string& output, const std::size_t from, const std::size_t to)
+    {
+        if (from == to) {
+            return;
+        }
+
+        const auto distance = from > to ? from - to : to - from;
+
+        if ((1 == distance) && (from > to)) {
+            output.push_back('\b');
+        }
+        else {
+            output.append("\x1B[").append(std::to_string(distance)).push_back(from > to ? 'D' : 'C');
+        }
+    }
+}
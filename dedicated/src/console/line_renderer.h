@@ -0,0 +1,49 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Computes the terminal output that brings the displayed input line up to date.
+     *
+     * The renderer remembers what is on the screen and emits only the changed tail of the line
+     * and ANSI cursor movements (CSI n D, CSI n C, CSI K), so each edit is a single short write
+     * regardless of the line length.
+     */
+    class LineRenderer
+    {
+      public:
+        /**
+         * @brief Returns the output that turns the displayed line into \p text with the cursor at \p cursor.
+         */
+        [[nodiscard]] std::string update(std::string_view text, std::size_t cursor);
+
+        /**
+         * @brief Forgets the displayed line, e.g. after a line break.
+         */
+        void reset() noexcept;
+
+      private:
+        /* Text currently displayed on the screen. */
+        std::string displayed_{};
+
+        /* Cursor position on the screen, relative to the line start. */
+        std::size_t cursor_{};
+
+        /* Appends a horizontal cursor movement to the output. */
+        static void move_cursor(std::string& output, std::size_t from, std::size_t to);
+    };
+
+    inline void LineRenderer::reset() noexcept
+    {
+        displayed_.clear();
+        cursor_ = 0;
+    }
+}
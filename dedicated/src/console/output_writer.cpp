@@ -0,0 +1,232 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "console/output_writer.h"
+#include "cpputils/format.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifndef _WIN32
+  #include "realtime.h"
+  #include <sys/uio.h>
+  #include <cerrno>
+  #include <unistd.h>
+#endif
+
+namespace
+{
+    void write_synchronously(const std::string_view text)
+    {
+        std::fwrite(text.data(), 1, text.size(), stdout);
+        std::fflush(stdout);
+    }
+
+#ifndef _WIN32
+    void write_vector(std::array<::iovec, std::tuple_size_v<rehlds::dedicated::OutputSegments>>& vectors,
+      std::size_t count)
+    {
+        auto* current = vectors.data();
+
+        while (count > 0) {
+            const auto written = ::writev(STDOUT_FILENO, current, static_cast<int>(count));
+
+            if (written < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+
+                // Non-blocking or broken output, nothing sensible left to do with the text
+                return;
+            }
+
+            // Skip the fully written vectors and advance into the partially written one
+            auto remaining = static_cast<std::size_t>(written);
+
+            while ((count > 0) && (remaining >= current->iov_len)) {
+                remaining -= current->iov_len;
+                ++current;
+                --count;
+            }
+
+            if (count > 0) {
+                current->iov_base = static_cast<char*>(current->iov_base) + remaining;
+                current->iov_len -= remaining;
+            }
+        }
+    }
+#endif
+}
+
+namespace rehlds::dedicated
+{
+    void StandardOutputSink::write(const OutputSegments& segments)
+    {
+#ifdef _WIN32
+        for (const auto segment : segments) {
+            std::fwrite(segment.data(), 1, segment.size(), stdout);
+        }
+
+        std::fflush(stdout);
+#else
+        std::array<::iovec, std::tuple_size_v<OutputSegments>> vectors{};
+        std::size_t count = 0;
+
+        for (const auto segment : segments) {
+            if (!segment.empty()) {
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+                vectors[count].iov_base = const_cast<char*>(segment.data());
+                vectors[count].iov_len = segment.size();
+                ++count;
+            }
+        }
+
+        write_vector(vectors, count);
+#endif
+    }
+
+    void OutputWriter::start(std::unique_ptr<OutputSink> sink, const std::size_t capacity)
+    {
+        assert(sink != nullptr);
+        assert(capacity > 0);
+        stop();
+
+        // Text printed so far is still in the stdio buffer
+        if (write_through_) {
+            std::fflush(stdout);
+        }
+
+        sink_ = std::move(sink);
+        buffer_.assign(capacity, '\0');
+        flush_threshold_ = std::min(FLUSH_THRESHOLD, capacity / 2);
+        head_ = 0;
+        size_ = 0;
+        stopping_ = false;
+        reported_messages_ = dropped_messages_.load(std::memory_order_relaxed);
+
+        thread_ = std::thread{&OutputWriter::writer_loop, this};
+        started_.store(true, std::memory_order_release);
+    }
+
+    void OutputWriter::stop()
+    {
+        if (!thread_.joinable()) {
+            return;
+        }
+
+        {
+            const std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+
+        condition_.notify_one();
+        thread_.join();
+        started_.store(false, std::memory_order_release);
+
+        sink_.reset();
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+    }
+
+    bool OutputWriter::write(const std::string_view text)
+    {
+        if (text.empty()) {
+            return true;
+        }
+
+        if (!started()) {
+            if (write_through_) {
+                write_synchronously(text);
+            }
+
+            return true;
+        }
+
+        std::unique_lock lock{mutex_};
+
+        if (stopping_) {
+            lock.unlock();
+
+            if (write_through_) {
+                write_synchronously(text);
+            }
+
+            return true;
+        }
+
+        const auto capacity = buffer_.size();
+
+        if (text.size() > capacity - size_) {
+            dropped_messages_.fetch_add(1, std::memory_order_relaxed);
+            dropped_bytes_.fetch_add(text.size(), std::memory_order_relaxed);
+            return false;
+        }
+
+        const auto tail = (head_ + size_) % capacity;
+        const auto first = std::min(text.size(), capacity - tail);
+        std::memcpy(&buffer_[tail], text.data(), first);
+        std::memcpy(buffer_.data(), text.data() + first, text.size() - first);
+
+        const auto previous_size = size_;
+        size_ += text.size();
+
+        // Wake up the writer only when it has to start a batch or to cut the current batch short
+        const auto notify = (0 == previous_size) || ((previous_size < flush_threshold_) && (size_ >= flush_threshold_));
+        lock.unlock();
+
+        if (notify) {
+            condition_.notify_one();
+        }
+
+        return true;
+    }
+
+    void OutputWriter::writer_loop()
+    {
+#ifndef _WIN32
+        set_background_thread_policy();
+#endif
+        std::string notice{};
+        std::unique_lock lock{mutex_};
+
+        while (true) {
+            condition_.wait(lock, [this] { return stopping_ || (size_ > 0); });
+
+            if (stopping_ && (0 == size_)) {
+                break;
+            }
+
+            // Let the batch grow until it is large enough or old enough
+            condition_.wait_for(lock, FLUSH_INTERVAL, [this] { return stopping_ || (size_ >= flush_threshold_); });
+
+            const auto capacity = buffer_.size();
+            const auto size = size_;
+            const auto first = std::min(size, capacity - head_);
+
+            // Producers only append behind the tail, so the snapshot is stable while unlocked
+            OutputSegments segments{};
+            segments[1] = std::string_view{&buffer_[head_], first};
+            segments[2] = std::string_view{buffer_.data(), size - first};
+
+            notice.clear();
+
+            if (const auto dropped = dropped_messages_.load(std::memory_order_relaxed); dropped != reported_messages_) {
+                notice = cpputils::format("WARNING! Console output buffer overflow, {} messages dropped.\n",
+                  dropped - reported_messages_);
+                reported_messages_ = dropped;
+                segments[0] = notice;
+            }
+
+            lock.unlock();
+            sink_->write(segments);
+            lock.lock();
+
+            head_ = (head_ + size) % capacity;
+            size_ -= size;
+        }
+    }
+}
@@ -0,0 +1,196 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "cpputils/singleton_holder.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Contiguous pieces of output written by a single sink call.
+     */
+    using OutputSegments = std::array<std::string_view, 3>;
+
+    /**
+     * @brief Destination of the buffered output.
+     */
+    class OutputSink
+    {
+      public:
+        OutputSink() = default;
+        OutputSink(OutputSink&&) = delete;
+        OutputSink(const OutputSink&) = delete;
+        OutputSink& operator=(OutputSink&&) = delete;
+        OutputSink& operator=(const OutputSink&) = delete;
+        virtual ~OutputSink() = default;
+
+        /**
+         * @brief Writes the segments in order; empty segments are skipped.
+         */
+        virtual void write(const OutputSegments& segments) = 0;
+    };
+
+    /**
+     * @brief Sink that writes to the standard output, with a single \c writev() call on POSIX systems.
+     */
+    class StandardOutputSink final : public OutputSink
+    {
+      public:
+        void write(const OutputSegments& segments) override;
+    };
+
+    /**
+     * @brief Asynchronous batched output writer.
+     *
+     * Callers copy the text into a preallocated ring buffer, which takes a short lock and no system
+     * calls in the common case. A background thread coalesces the buffered text and hands it to the sink
+     * in large writes, either when \c FLUSH_THRESHOLD bytes are buffered or \c FLUSH_INTERVAL after the
+     * first buffered byte. The memory is bounded: a message that does not fit is dropped and counted,
+     * and the writer reports the number of dropped messages in the output stream.
+     *
+     * Until \c start() and after \c stop() the text is written synchronously to the standard output,
+     * unless the writer is created without the write-through, in which case it is discarded.
+     */
+    class OutputWriter
+    {
+      public:
+        /* Amount of buffered text that wakes up the writer thread before the flush interval. */
+        static constexpr std::size_t FLUSH_THRESHOLD = 16 * 1024;
+
+        /* Maximum time the text stays in the buffer. */
+        static constexpr std::chrono::milliseconds FLUSH_INTERVAL{10};
+
+        OutputWriter() = default;
+        explicit OutputWriter(bool write_through);
+        OutputWriter(OutputWriter&&) = delete;
+        OutputWriter(const OutputWriter&) = delete;
+        OutputWriter& operator=(OutputWriter&&) = delete;
+        OutputWriter& operator=(const OutputWriter&) = delete;
+        ~OutputWriter();
+
+        /**
+         * @brief Allocates the ring buffer and starts the writer thread.
+         *
+         * @param sink Destination of the output.
+         * @param capacity Ring buffer size, in bytes.
+         */
+        void start(std::unique_ptr<OutputSink> sink, std::size_t capacity);
+
+        /**
+         * @brief Writes out the buffered text and stops the writer thread.
+         */
+        void stop();
+
+        /**
+         * @brief Returns true if the writer thread is running.
+         */
+        [[nodiscard]] bool started() const noexcept;
+
+        /**
+         * @brief Queues the text for writing. If the writer is not started, the text is written
+         * synchronously to the standard output or discarded, depending on the write-through.
+         *
+         * @return \c false if the text was dropped because the buffer is full.
+         */
+        bool write(std::string_view text);
+
+        /**
+         * @brief Returns the number of messages dropped because the buffer was full.
+         */
+        [[nodiscard]] std::uint64_t dropped_messages() const noexcept;
+
+        /**
+         * @brief Returns the number of bytes dropped because the buffer was full.
+         */
+        [[nodiscard]] std::uint64_t dropped_bytes() const noexcept;
+
+      private:
+        /* Is the text written to the standard output while the writer thread is not running? */
+        bool write_through_{true};
+
+        /* Output destination. */
+        std::unique_ptr<OutputSink> sink_{};
+
+        /* Ring buffer storage. */
+        std::vector<char> buffer_{};
+
+        /* Amount of buffered text that wakes up the writer thread, limited to a half of the buffer. */
+        std::size_t flush_threshold_{};
+
+        /* Offset of the first buffered byte. */
+        std::size_t head_{};
+
+        /* Number of buffered bytes. */
+        std::size_t size_{};
+
+        /* Dropped messages counters. */
+        std::atomic<std::uint64_t> dropped_messages_{};
+        std::atomic<std::uint64_t> dropped_bytes_{};
+
+        /* Number of dropped messages already reported in the output. */
+        std::uint64_t reported_messages_{};
+
+        /* Is the writer thread asked to stop? */
+        bool stopping_{};
+
+        /* Is the writer thread running? */
+        std::atomic<bool> started_{};
+
+        /* Guards the ring buffer state. */
+        std::mutex mutex_{};
+
+        /* Signaled when the writer thread has work to do. */
+        std::condition_variable condition_{};
+
+        /* Writer thread. */
+        std::thread thread_{};
+
+        /* Writer thread entry point. */
+        void writer_loop();
+    };
+
+    inline OutputWriter::OutputWriter(const bool write_through) : write_through_(write_through)
+    {
+    }
+
+    inline OutputWriter::~OutputWriter()
+    {
+        stop();
+    }
+
+    inline bool OutputWriter::started() const noexcept
+    {
+        return started_.load(std::memory_order_acquire);
+    }
+
+    inline std::uint64_t OutputWriter::dropped_messages() const noexcept
+    {
+        return dropped_messages_.load(std::memory_order_relaxed);
+    }
+
+    inline std::uint64_t OutputWriter::dropped_bytes() const noexcept
+    {
+        return dropped_bytes_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns an output writer instance.
+     */
+    [[nodiscard]] inline OutputWriter& get_output_writer()
+    {
+        return cpputils::SingletonHolder<OutputWriter>::get_instance();
+    }
+}
@@ -3,9 +3,19 @@
  */
 
 #include "console/text_console.h"
+#include "commands.h"
 #include "common/hlds_module.h"
 #include "common/interfaces/dedicated_serverapi.h"
+#include "common/object_list.h"
+#include "console/console_log.h"
+#include "console/output_writer.h"
 #include "cpputils/string.h"
+#include "frame_stats.h"
+
+#ifndef _WIN32
+  #include "pool_allocator.h"
+  #include "status_publisher.h"
+#endif
 #include <algorithm>
 #include <array>
 #include <cassert>
@@ -14,6 +24,7 @@
 #include <cstring>
 #include <iostream>
 #include <utility>
+#include <vector>
 
 using namespace rehlds::common;
 
@@ -22,18 +33,23 @@ namespace
     constexpr auto MAX_BUFFER_LINES = 255;
     IDedicatedServerApi* engine_api{};
 
-    std::pair<std::string_view, std::string_view> get_smallest_longest_commands(const ObjectList& commands)
+    std::vector<std::string> get_engine_command_matches(ISystemBase* const system, const std::string& text)
     {
-        assert(!commands.empty());
+        std::vector<std::string> names{};
+
+        if (nullptr == system) {
+            return names;
+        }
+
+        ObjectList matches{};
+        system->get_command_matches(text.c_str(), &matches);
 
-        const auto& [smallest, longest] = std::minmax_element(commands.cbegin(), commands.cend(),
-          [](const void* const lhs, const void* const rhs)
-          {
-              return std::strlen(static_cast<const char*>(lhs)) < std::strlen(static_cast<const char*>(rhs));
-          });
+        // The engine owns the strings
+        for (const auto* const match : matches) {
+            names.emplace_back(static_cast<const char*>(match));
+        }
 
-        return std::make_pair(
-          std::string_view{static_cast<const char*>(*smallest)}, std::string_view{static_cast<const char*>(*longest)});
+        return names;
     }
 }
 
@@ -56,6 +72,16 @@ namespace rehlds::dedicated
         line_buffer_.clear();
         cursor_position_ = 0;
         browse_line_ = 0;
+        renderer_.reset();
+        map_name_.clear();
+        completion_index_.invalidate();
+
+        if (engine_detached_) {
+            detail::system = nullptr;
+            engine_api = nullptr;
+            return true;
+        }
+
         detail::system = get_engine_module().get_system();
 
         auto& engine_module = get_engine_module();
@@ -65,17 +91,36 @@ namespace rehlds::dedicated
         return initialized_;
     }
 
+    void TextConsole::attach_engine()
+    {
+        auto& engine_module = get_engine_module();
+        detail::system = engine_module.get_system();
+        engine_api = engine_module.get_interface<IDedicatedServerApi>(INTERFACE_DEDICATED_SERVER_API);
+        engine_detached_ = false;
+
+        // The commands and the map of the reloaded engine are not known yet
+        map_name_.clear();
+        completion_index_.invalidate();
+    }
+
     void TextConsole::terminate()
     {
         initialized_ = false;
     }
 
+    bool TextConsole::write(const std::string_view text)
+    {
+        get_console_log().write(text);
+        return get_output_writer().write(text);
+    }
+
     void TextConsole::update_status(const bool force)
     {
         constexpr std::chrono::milliseconds update_interval{500};
         static std::chrono::time_point<std::chrono::system_clock> time_last_update{};
 
-        if ((!force) && ((std::chrono::system_clock::now() - time_last_update) < update_interval)) {
+        if ((nullptr == engine_api) ||
+            ((!force) && ((std::chrono::system_clock::now() - time_last_update) < update_interval))) {
             return;
         }
 
@@ -84,28 +129,80 @@ namespace rehlds::dedicated
         auto maximum_players = 0;
         std::array<char, 32> map_name{};
         engine_api->update_status(&fps, &active_players, &maximum_players, map_name.data());
+        active_players_ = active_players;
+
+        // Plugins register their commands on map load
+        if (map_name_ != map_name.data()) {
+            map_name_ = map_name.data();
+            completion_index_.invalidate();
+
+#ifndef _WIN32
+            // The memory freed by the previous map goes back to the system
+            if (auto& pool = get_pool_allocator(); pool.trim_on_map_change()) {
+                pool.trim();
+            }
+#endif
+        }
 
-        const auto status = cpputils::format(
-          "FPS: {:.1f} | Players: {:d}/{:d} | Map: {}", fps, active_players, maximum_players, map_name.data());
+#ifndef _WIN32
+        if (auto& publisher = get_status_publisher(); publisher.is_open()) {
+            publisher.publish({fps, active_players, maximum_players, map_name.data()});
+        }
+#endif
+
+        const auto status = cpputils::format("FPS: {:.1f} | {} | Players: {:d}/{:d} | Map: {}", fps,
+          frame_stats_status(), active_players, maximum_players, map_name.data());
 
         set_status(status);
         time_last_update = std::chrono::system_clock::now();
     }
 
-    void TextConsole::delete_typed_line()
+    CompletionMatches TextConsole::find_command_matches(const std::string& text)
     {
-        if (!console_text_.empty()) {
-            receive_end();
+        auto matches = completion_index_.find(text);
 
-            for (auto i = console_text_.length(); i > 0; --i) {
-                std::cout << "\b \b";
-            }
+        if (completion_index_.needs_rebuild(matches.names.empty())) {
+            request_completion_index_rebuild(text);
+            matches = completion_index_.find(text);
+        }
+
+        return matches;
+    }
+
+    void TextConsole::rebuild_completion_index(const std::string& text)
+    {
+        // An empty prefix matches every registered command and variable
+        auto names = get_engine_command_matches(detail::system, {});
+        auto complete = true;
+
+        if (names.empty()) {
+            names = get_engine_command_matches(detail::system, text);
+            complete = false;
+        }
+
+        for (auto&& name : get_command_names()) {
+            names.emplace_back(std::move(name));
         }
+
+        completion_index_.rebuild(std::move(names), complete);
+    }
+
+    void TextConsole::request_completion_index_rebuild(const std::string& text)
+    {
+        rebuild_completion_index(text);
+    }
+
+    void TextConsole::delete_typed_line()
+    {
+        std::cout << renderer_.update({}, 0) << std::flush;
     }
 
     void TextConsole::receive_newline()
     {
-        std::cout << '\n';
+        auto output = renderer_.update(console_text_, console_text_.length());
+        output.push_back('\n');
+        std::cout << output << std::flush;
+        renderer_.reset();
 
         // Cache line in buffer, but only if it's not a duplicate of the previous line.
         if ((!console_text_.empty()) && (line_buffer_.empty() || (line_buffer_.back() != console_text_))) {
@@ -129,30 +226,22 @@ namespace rehlds::dedicated
 
         --cursor_position_;
         console_text_.erase(cursor_position_, 1);
-
-        std::cout << '\b';
-        std::cout << (console_text_.c_str() + cursor_position_);
-        std::cout << ' ';
-
-        for (auto i = console_text_.length() + 1; i > cursor_position_; --i) {
-            std::cout << '\b';
-        }
+        render();
     }
 
     void TextConsole::receive_tab()
     {
-        if ((nullptr == detail::system) || console_text_.empty()) {
+        if (console_text_.empty()) {
             return;
         }
 
-        ObjectList matches{};
-        detail::system->get_command_matches(console_text_.c_str(), &matches);
+        const auto matches = find_command_matches(console_text_);
 
-        if (matches.empty()) {
+        if (matches.names.empty()) {
             return;
         }
 
-        if (1 == matches.size()) {
+        if (1 == matches.names.size()) {
             process_single_command_match(matches);
         }
         else {
@@ -160,6 +249,7 @@ namespace rehlds::dedicated
         }
 
         cursor_position_ = console_text_.length();
+        render();
     }
 
     void TextConsole::receive_up_arrow()
@@ -172,13 +262,10 @@ namespace rehlds::dedicated
             saved_console_text_ = console_text_;
         }
 
-        delete_typed_line();
         --browse_line_;
-
         console_text_ = line_buffer_[browse_line_];
-        std::cout << console_text_;
-
         cursor_position_ = console_text_.length();
+        render();
     }
 
     void TextConsole::receive_down_arrow()
@@ -187,7 +274,6 @@ namespace rehlds::dedicated
             return;
         }
 
-        delete_typed_line();
         ++browse_line_;
 
         if (line_buffer_.size() == browse_line_) {
@@ -197,8 +283,8 @@ namespace rehlds::dedicated
             console_text_ = line_buffer_[browse_line_];
         }
 
-        std::cout << console_text_;
         cursor_position_ = console_text_.length();
+        render();
     }
 
     void TextConsole::receive_left_arrow()
@@ -207,8 +293,8 @@ namespace rehlds::dedicated
             return;
         }
 
-        std::cout << '\b';
         --cursor_position_;
+        render();
     }
 
     void TextConsole::receive_right_arrow()
@@ -217,22 +303,20 @@ namespace rehlds::dedicated
             return;
         }
 
-        std::cout << console_text_[cursor_position_];
         ++cursor_position_;
+        render();
     }
 
     void TextConsole::receive_home()
     {
-        while (cursor_position_ > 0) {
-            receive_left_arrow();
-        }
+        cursor_position_ = 0;
+        render();
     }
 
     void TextConsole::receive_end()
     {
-        while (cursor_position_ < console_text_.length()) {
-            receive_right_arrow();
-        }
+        cursor_position_ = console_text_.length();
+        render();
     }
 
     void TextConsole::receive_escape_sequence(const std::array<std::string::value_type, 3>& sequence)
@@ -252,69 +336,63 @@ namespace rehlds::dedicated
     {
         if (std::isprint(static_cast<unsigned char>(character)) != 0) {
             console_text_.insert(cursor_position_, 1, character);
-
-            std::cout << (console_text_.c_str() + cursor_position_);
             ++cursor_position_;
-
-            for (auto i = console_text_.length(); i > cursor_position_; --i) {
-                std::cout << '\b';
-            }
+            render();
         }
     }
 
     void TextConsole::receive_text(const std::string_view text)
     {
         for (const auto character : text) {
-            receive_character(character);
+            if (std::isprint(static_cast<unsigned char>(character)) != 0) {
+                console_text_.insert(cursor_position_, 1, character);
+                ++cursor_position_;
+            }
         }
+
+        render();
     }
 
-    void TextConsole::process_single_command_match(const ObjectList& matches)
+    void TextConsole::render()
     {
-        assert(1 == matches.size());
-
-        const auto* const match = static_cast<const char*>(matches[0]);
-        const auto* const rest = match + console_text_.length();
+        // A single write per edit
+        std::cout << renderer_.update(console_text_, cursor_position_) << std::flush;
+    }
 
-        console_text_.append(rest);
-        std::cout << rest;
+    void TextConsole::process_single_command_match(const CompletionMatches& matches)
+    {
+        assert(1 == matches.names.size());
 
+        console_text_ = matches.names.front();
         console_text_.push_back(' ');
-        std::cout << ' ';
     }
 
-    void TextConsole::process_multiple_command_matches(ObjectList& matches)
+    void TextConsole::process_multiple_command_matches(const CompletionMatches& matches)
     {
-        assert(matches.size() > 1);
-        const auto& [smallest, longest] = get_smallest_longest_commands(matches);
+        assert(matches.names.size() > 1);
 
-        delete_typed_line();
-        std::cout << '\n';
+        std::string output = renderer_.update({}, 0);
+        output.push_back('\n');
+        renderer_.reset();
 
-        std::string common{smallest};
-        common = cpputils::lower(common);
+        const auto column_width = matches.longest_length + 2;
+        const auto total_columns = std::max(static_cast<std::size_t>(width() - 1) / column_width, std::size_t{1});
 
-        const auto total_columns = static_cast<std::size_t>(width() - 1) / (longest.length() + 1);
         std::size_t current_column = 0;
 
-        for (const auto* const match : matches) {
+        for (const auto& name : matches.names) {
             ++current_column;
 
             if (current_column > total_columns) {
                 current_column = 1;
-                std::cout << '\n';
+                output.push_back('\n');
             }
 
-            std::string command{static_cast<const char*>(match)};
-            command = cpputils::lower(command);
-            std::cout << cpputils::format("{:<{}}  ", command, longest.length());
-
-            const auto& [mismatch1, mismatch2] = std::mismatch(common.cbegin(), common.cend(), command.cbegin());
-            common.erase(mismatch1, common.cend());
+            output.append(name).append(column_width - name.length(), ' ');
         }
 
-        std::cout << '\n';
-        console_text_ = std::move(common);
-        std::cout << console_text_;
+        output.push_back('\n');
+        std::cout << output << std::flush;
+        console_text_ = matches.common_prefix;
     }
 }
@@ -4,12 +4,14 @@
 
 #pragma once
 
-#include "common/object_list.h"
+#include "console/completion_index.h"
+#include "console/line_renderer.h"
 #include "cpputils/format.h"
 #include <array>
 #include <cstdio>
 #include <deque>
 #include <string>
+#include <string_view>
 #include <utility>
 
 namespace rehlds::dedicated
@@ -32,8 +34,28 @@ namespace rehlds::dedicated
         template <typename... Args>
         static int print(std::string format, Args&&... args);
 
+        /**
+         * @brief Writes the text as is to the console output and the console log.
+         *
+         * @return \c false if the console output buffer is full and the text was dropped.
+         */
+        static bool write(std::string_view text);
+
         virtual bool init();
         virtual void terminate();
+
+        /**
+         * @brief Detaches the console from the engine module, so it does not load it and serves
+         * the input and output of the launcher only. Must be called before \c init().
+         */
+        void detach_engine() noexcept;
+
+        /**
+         * @brief Attaches the initialized console to the engine interfaces again, after the engine
+         * module was reloaded and initialized.
+         */
+        void attach_engine();
+
         virtual bool get_line(std::string& text) = 0;
         [[nodiscard]] virtual int width() const = 0;
         virtual void set_title(const std::string& title) = 0;
@@ -44,7 +66,32 @@ namespace rehlds::dedicated
         [[nodiscard]] bool initialized() const;
         [[nodiscard]] const std::string& console_text() const;
 
+        /**
+         * @brief Returns the number of the active players read at the last status update,
+         * or -1 before the first update.
+         */
+        [[nodiscard]] int active_players() const;
+
       protected:
+        /**
+         * @brief Returns the console commands and variables that start with the specified text.
+         *
+         * Served from the completion index, which is rebuilt first if it is outdated.
+         */
+        [[nodiscard]] CompletionMatches find_command_matches(const std::string& text);
+
+        /**
+         * @brief Rebuilds the completion index from the names registered in the engine and the launcher.
+         *
+         * Calls into the engine, so it must run on the server loop thread.
+         */
+        void rebuild_completion_index(const std::string& text);
+
+        /**
+         * @brief Gets the completion index rebuilt before a lookup on the console input thread.
+         */
+        virtual void request_completion_index_rebuild(const std::string& text);
+
         void delete_typed_line();
         void receive_newline();
         void receive_backspace();
@@ -65,6 +112,9 @@ namespace rehlds::dedicated
         /* Is the console already initialized? */
         bool initialized_{};
 
+        /* Does the console work without the engine module? */
+        bool engine_detached_{};
+
         /* Console text buffer. */
         std::string console_text_{};
 
@@ -80,18 +130,35 @@ namespace rehlds::dedicated
         /* Position in the current input line. */
         std::string::size_type cursor_position_{};
 
-        /* Prints the single command match to console. */
-        void process_single_command_match(const common::ObjectList& matches);
+        /* Command and variable names for tab completion. */
+        CompletionIndex completion_index_{};
+
+        /* Map name at the last status update, a map change invalidates the completion index. */
+        std::string map_name_{};
+
+        /* Number of the active players at the last status update. */
+        int active_players_{-1};
+
+        /* Terminal state of the input line. */
+        LineRenderer renderer_{};
 
-        /* Prints the multiple command matches to console. */
-        void process_multiple_command_matches(common::ObjectList& matches);
+        /* Brings the displayed input line up to date with a single write. */
+        void render();
+
+        /* Completes the input line with the single command match. */
+        void process_single_command_match(const CompletionMatches& matches);
+
+        /* Prints the multiple command matches to console and completes their common prefix. */
+        void process_multiple_command_matches(const CompletionMatches& matches);
     };
 
     template <typename... Args>
     int TextConsole::print(std::string format, Args&&... args)
     {
-        cpputils::print(std::move(format), std::forward<Args>(args)...);
-        return std::fflush(stdout);
+        cpputils::MemoryBuffer buffer{};
+        cpputils::format_to(buffer, format, std::forward<Args>(args)...);
+
+        return write(std::string_view{buffer.data(), buffer.size()}) ? 0 : EOF;
     }
 
     inline void TextConsole::update_status()
@@ -99,6 +166,11 @@ namespace rehlds::dedicated
         update_status(false);
     }
 
+    inline void TextConsole::detach_engine() noexcept
+    {
+        engine_detached_ = true;
+    }
+
     [[nodiscard]] inline bool TextConsole::initialized() const
     {
         return initialized_;
@@ -108,4 +180,9 @@ namespace rehlds::dedicated
     {
         return console_text_;
     }
+
+    [[nodiscard]] inline int TextConsole::active_players() const
+    {
+        return active_players_;
+    }
 }
@@ -3,17 +3,21 @@
  */
 
 #include "console/text_console_unix.h"
+#include "realtime.h"
 #include "cpputils/singleton_holder.h"
 #include <sys/ioctl.h>
 #include <sys/poll.h>
 #include <array>
 #include <cerrno>
+#include <chrono>
 #include <csignal>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <streambuf>
+#include <fcntl.h>
+#include <pthread.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -83,10 +87,30 @@ namespace
         }
     }
 
-    bool keyboard_hit()
+    /* Maximum time the console thread waits for the server loop to rebuild the completion index. */
+    constexpr auto COMPLETION_TIMEOUT = std::chrono::milliseconds{1000};
+
+    void close_descriptor(int& descriptor) noexcept
+    {
+        if (descriptor >= 0) {
+            ::close(descriptor);
+            descriptor = -1;
+        }
+    }
+
+    bool create_wake_pipe(std::array<int, 2>& descriptors)
     {
-        std::array<pollfd, 1> descriptor{{{0, POLLIN, 0}}};
-        return ::poll(descriptor.data(), 1, 0) > 0;
+        if (0 != ::pipe(descriptors.data())) {
+            descriptors = {-1, -1};
+            return false;
+        }
+
+        for (const auto descriptor : descriptors) {
+            ::fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+            ::fcntl(descriptor, F_SETFL, ::fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+        }
+
+        return true;
     }
 }
 
@@ -116,11 +140,35 @@ namespace rehlds::dedicated
         init_term();
         init_tty();
 
+        if (!create_wake_pipe(wake_pipe_)) {
+            print("WARNING! Unable to create the console wake pipe: {}\n", std::strerror(errno));
+            return true;
+        }
+
+        // The console thread inherits the signal mask, so the signals keep being delivered to the server loop
+        ::sigset_t signals{};
+        ::sigset_t signals_stored{};
+        ::sigfillset(&signals);
+        ::pthread_sigmask(SIG_SETMASK, &signals, &signals_stored);
+
+        running_.store(true, std::memory_order_release);
+        input_thread_ = std::thread{&TextConsoleUnix::input_loop, this};
+        ::pthread_sigmask(SIG_SETMASK, &signals_stored, nullptr);
+
         return true;
     }
 
     void TextConsoleUnix::terminate()
     {
+        if (input_thread_.joinable()) {
+            running_.store(false, std::memory_order_release);
+            wake();
+            input_thread_.join();
+        }
+
+        close_descriptor(wake_pipe_[0]);
+        close_descriptor(wake_pipe_[1]);
+
         if (initialized()) {
             const BlockTty block_tty{};
             ::tcsetattr(STDIN_FILENO, TCSANOW, &termios_stored);
@@ -140,39 +188,11 @@ namespace rehlds::dedicated
 
     bool TextConsoleUnix::get_line(std::string& text)
     {
-        // Early return for 99.999% case :)
-        if (!keyboard_hit()) {
-            return false;
+        if (!completion_requests_.empty()) {
+            process_completion_request();
         }
 
-        const BlockTty block_tty{};
-        char character{};
-
-        while (keyboard_hit() && (::read(STDIN_FILENO, &character, 1) > 0)) {
-            switch (character) {
-                case '\n': {
-                    text = console_text();
-                    receive_newline();
-                    return true;
-                }
-
-                case '\x1B': {
-                    if (std::array<std::string::value_type, 3> sequence{'\x1B', '\0', '\0'};
-                        ::read(STDIN_FILENO, &sequence[1], sequence.size() - 1) > 0) {
-                        receive_escape_sequence(sequence);
-                    }
-                    break;
-                }
-
-                case 127:
-                case '\b': receive_backspace(); break;
-                case '\t': receive_tab(); break;
-                case '\0': continue;
-                default: receive_character(character); break;
-            }
-        }
-
-        return false;
+        return lines_.try_pop(text);
     }
 
     int TextConsoleUnix::width() const
@@ -204,4 +224,135 @@ namespace rehlds::dedicated
     void TextConsoleUnix::set_status(const std::string /* unused */) //-V801
     {
     }
+
+    void TextConsoleUnix::request_completion_index_rebuild(const std::string& text)
+    {
+        // Called by the console thread: hand the request over to the server loop and wait for the reply
+        const auto id = ++completion_id_;
+
+        if (!completion_requests_.try_push(CompletionRequest{id, text})) {
+            return;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + COMPLETION_TIMEOUT;
+        std::uint32_t reply = 0;
+
+        while (running_.load(std::memory_order_acquire)) {
+            while (completion_replies_.try_pop(reply)) {
+                // Replies to the requests that have timed out earlier are discarded
+                if (id == reply) {
+                    return;
+                }
+            }
+
+            const auto remaining =
+              std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+
+            if ((remaining.count() <= 0) || (!wait_wake(static_cast<int>(remaining.count()) + 1))) {
+                break;
+            }
+        }
+    }
+
+    void TextConsoleUnix::input_loop()
+    {
+        set_background_thread_policy();
+        std::array<::pollfd, 2> descriptors{{{STDIN_FILENO, POLLIN, 0}, {wake_pipe_[0], POLLIN, 0}}};
+
+        while (running_.load(std::memory_order_acquire)) {
+            if (::poll(descriptors.data(), descriptors.size(), -1) < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+
+                break;
+            }
+
+            if (0 != descriptors[1].revents) {
+                wait_wake(0);
+            }
+
+            if (0 == (descriptors[0].revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL))) {
+                continue;
+            }
+
+            // Stop polling the input once it is closed, e.g. when stdin is redirected from /dev/null
+            if (!read_input()) {
+                descriptors[0].fd = -1;
+            }
+        }
+    }
+
+    bool TextConsoleUnix::read_input()
+    {
+        char character{};
+        const auto result = ::read(STDIN_FILENO, &character, 1);
+
+        if (result <= 0) {
+            return (result < 0) && ((EINTR == errno) || (EAGAIN == errno));
+        }
+
+        switch (character) {
+            case '\n': {
+                if (!lines_.try_push(console_text())) {
+                    print("WARNING! Console input queue is full, the line is dropped.\n");
+                }
+
+                receive_newline();
+                break;
+            }
+
+            case '\x1B': {
+                if (std::array<std::string::value_type, 3> sequence{'\x1B', '\0', '\0'};
+                    ::read(STDIN_FILENO, &sequence[1], sequence.size() - 1) > 0) {
+                    receive_escape_sequence(sequence);
+                }
+                break;
+            }
+
+            case 127:
+            case '\b': receive_backspace(); break;
+            case '\t': receive_tab(); break;
+            case '\0': break;
+            default: receive_character(character); break;
+        }
+
+        return true;
+    }
+
+    void TextConsoleUnix::process_completion_request()
+    {
+        CompletionRequest request{};
+
+        while (completion_requests_.try_pop(request)) {
+            rebuild_completion_index(request.text);
+
+            if (completion_replies_.try_push(request.id)) {
+                wake();
+            }
+        }
+    }
+
+    void TextConsoleUnix::wake() const noexcept
+    {
+        if (wake_pipe_[1] >= 0) {
+            const char signal{};
+            [[maybe_unused]] const auto result = ::write(wake_pipe_[1], &signal, 1);
+        }
+    }
+
+    bool TextConsoleUnix::wait_wake(const int timeout) const
+    {
+        std::array<::pollfd, 1> descriptor{{{wake_pipe_[0], POLLIN, 0}}};
+
+        if (::poll(descriptor.data(), descriptor.size(), timeout) <= 0) {
+            return false;
+        }
+
+        // Drain the pipe, the wake ups are not counted
+        std::array<char, 64> buffer{};
+        while (::read(wake_pipe_[0], buffer.data(), buffer.size()) > 0) {}
+
+        return true;
+    }
 }
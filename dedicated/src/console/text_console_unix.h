@@ -5,9 +5,34 @@
 #pragma once
 
 #include "console/text_console.h"
+#include "cpputils/spsc_queue.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
 
 namespace rehlds::dedicated
 {
+    /**
+     * @brief Completion index rebuild request posted by the console thread.
+     */
+    struct CompletionRequest
+    {
+        std::uint32_t id{};
+        std::string text{};
+    };
+
+    /**
+     * @brief Text console for Unix terminals.
+     *
+     * The terminal input is read and edited by a dedicated console thread. Completed lines are
+     * handed to the server loop through a single-producer/single-consumer queue, so \c get_line()
+     * is a wait-free pop. Tab completion is served from the completion index on the console thread;
+     * rebuilding the index queries the engine, which may only be called from the server loop, so
+     * the console thread posts the request and waits for \c get_line() to process it.
+     */
     class TextConsoleUnix final : public TextConsole
     {
         friend TextConsole& TextConsole::instance();
@@ -26,5 +51,48 @@ namespace rehlds::dedicated
         [[nodiscard]] int width() const override;
         void set_title(const std::string& title) override;
         void set_status(std::string status) override;
+
+      protected:
+        void request_completion_index_rebuild(const std::string& text) override;
+
+      private:
+        /* Maximum number of completed lines waiting for the server loop. */
+        static constexpr std::size_t LINE_QUEUE_SIZE = 64;
+
+        /* Console thread reading the terminal input. */
+        std::thread input_thread_{};
+
+        /* Is the console thread running? */
+        std::atomic<bool> running_{};
+
+        /* Pipe used to wake up the console thread, read end first. */
+        std::array<int, 2> wake_pipe_{-1, -1};
+
+        /* Identifier of the last completion index rebuild request. */
+        std::uint32_t completion_id_{};
+
+        /* Completed lines, console thread to server loop. */
+        cpputils::SpscQueue<std::string, LINE_QUEUE_SIZE> lines_{};
+
+        /* Completion index rebuild requests, console thread to server loop. */
+        cpputils::SpscQueue<CompletionRequest, 2> completion_requests_{};
+
+        /* Identifiers of the processed rebuild requests, server loop to console thread. */
+        cpputils::SpscQueue<std::uint32_t, 2> completion_replies_{};
+
+        /* Console thread entry point. */
+        void input_loop();
+
+        /* Reads and processes a single key press. Returns false if the input is closed. */
+        bool read_input();
+
+        /* Processes a pending completion index rebuild request, called by the server loop. */
+        void process_completion_request();
+
+        /* Wakes up the console thread. */
+        void wake() const noexcept;
+
+        /* Waits for a wake up of the console thread. */
+        bool wait_wake(int timeout) const;
     };
 }
@@ -13,6 +13,10 @@
 #include <vector>
 #include <Windows.h>
 
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+  #define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
+
 namespace
 {
     ::HWND handle_window{};
@@ -62,6 +66,12 @@ namespace rehlds::dedicated
         handle_window = ::GetConsoleWindow();
         handle_input = ::GetStdHandle(STD_INPUT_HANDLE);
         handle_output = ::GetStdHandle(STD_OUTPUT_HANDLE);
+
+        // The line editor moves the cursor with ANSI escape sequences
+        if (::DWORD mode = 0; ::GetConsoleMode(handle_output, &mode) != FALSE) {
+            ::SetConsoleMode(handle_output, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        }
+
         set_title("GoldSrc Dedicated Server");
 
         return true;
@@ -4,28 +4,146 @@
 
 #include "dedicated.h"
 #include "arguments.h"
+#include "clock.h"
 #include "command_line.h"
+#include "commands.h"
 #include "common/hlds_module.h"
 #include "common/interfaces/dedicated_serverapi.h"
 #include "common/interfaces/filesystem.h"
 #include "common/platform.h"
+#include "console/console_log.h"
+#include "console/output_writer.h"
 #include "console/text_console.h"
+#include "cpputils/format.h"
+#include "cpputils/system.h"
+#include "cpputils/trace.h"
+#include "frame_stats.h"
 #include "sleep.h"
+
+#ifndef _WIN32
+  #include "game_reload.h"
+  #include "heap_profiler.h"
+  #include "idle_governor.h"
+  #include "pool_allocator.h"
+  #include "prewarm.h"
+  #include "sampling_profiler.h"
+  #include "server_host.h"
+  #include "stall_watchdog.h"
+  #include "status_publisher.h"
+  #include "zygote.h"
+#endif
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
 #include <string>
+#include <utility>
 
 using namespace rehlds::common;
 using namespace rehlds::dedicated;
 
 namespace
 {
+    /* Has hlds_restart asked for an engine restart after the current frame? */
+    bool restart_requested = false;
+
+    /* Parameters hlds_restart adds to the command line of the restarted engine. */
+    std::string restart_params{};
+
+    /**
+     * @brief Handler of the \c hlds_restart console command.
+     */
+    void restart_command(const std::string& args)
+    {
+        restart_requested = true;
+        restart_params = args;
+        TextConsole::print("Restarting the engine after the current frame.\n");
+    }
+
+#ifndef _WIN32
+    /* Game module hlds_gamereload installs while the engine is restarted, empty to reload the installed one. */
+    std::string game_module_update{};
+
+    /**
+     * @brief Restarts the engine on the current map, installing the game module first unless it is empty.
+     *
+     * The engine loads and releases the game module itself, so the game module is reloaded by
+     * an engine restart that loads the current map again.
+     */
+    void request_game_reload(std::string module)
+    {
+        auto fps = 0.F;
+        auto active_players = 0;
+        auto max_players = 0;
+        std::array<char, 32> map{};
+
+        auto* const engine_api =
+          get_engine_module().get_interface<IDedicatedServerApi>(INTERFACE_DEDICATED_SERVER_API);
+
+        if (nullptr != engine_api) {
+            engine_api->update_status(&fps, &active_players, &max_players, map.data());
+        }
+
+        game_module_update = std::move(module);
+        restart_requested = true;
+        restart_params = '\0' == map.front() ? std::string{} : cpputils::format("+map {}", map.data());
+        TextConsole::print("Reloading the game module after the current frame.\n");
+    }
+
+    /**
+     * @brief Handler of the \c hlds_gamereload console command.
+     *
+     * A replacement module is checked on a background thread; the server loop requests the reload
+     * at the frame boundary after the check passed.
+     */
+    void game_reload_command(const std::string& args)
+    {
+        if (args.empty()) {
+            request_game_reload({});
+        }
+        else if (get_game_module_check().start(args)) {
+            TextConsole::print("Checking the game module \"{}\".\n", args);
+        }
+        else {
+            TextConsole::print("WARNING! hlds_gamereload: A game module check is already running.\n");
+        }
+    }
+
+    /**
+     * @brief Reloads the game module if the check of its replacement has passed.
+     */
+    void apply_game_module_check()
+    {
+        if (auto& check = get_game_module_check(); check.take_result()) {
+            request_game_reload(check.path());
+        }
+    }
+#endif
+
+    /**
+     * @brief Prints the engine exports the launcher calls directly and the loaded engine module does not export.
+     */
+    void report_missing_exports()
+    {
+        get_engine_module().exports().for_each_missing(
+          [](const char* const name)
+          {
+              TextConsole::print("WARNING! The engine module does not export {}.\n", name);
+          });
+    }
+
     [[nodiscard]] bool load_modules()
     {
+        const cpputils::TraceSpan span{"load_modules"};
+
         if (!get_engine_module().load()) {
             TextConsole::print("Unable to load engine module, image is corrupt.\n");
             return false;
         }
 
+        report_missing_exports();
+
         if (!get_filesystem_module().load()) {
             TextConsole::print("Unable to load filesystem module, image is corrupt.\n");
             return false;
@@ -58,6 +176,14 @@ namespace
 
     bool init_console(TextConsole& console)
     {
+        const cpputils::TraceSpan span{"init_console"};
+
+        // After an engine restart the console keeps running and only needs the new engine interfaces
+        if (console.initialized()) {
+            console.attach_engine();
+            return true;
+        }
+
         if (!console.init()) {
             TextConsole::print("Failed to initialize console.\n");
             return false;
@@ -69,6 +195,8 @@ namespace
     bool init_engine(IDedicatedServerApi* const engine_api, const char* const cmdline,
       const CreateInterfaceFn launcher_factory, const CreateInterfaceFn filesystem_factory)
     {
+        const cpputils::TraceSpan span{"init_engine"};
+
         if (!engine_api->init(".", cmdline, launcher_factory, filesystem_factory)) {
             TextConsole::print("Failed to initialize engine API.\n");
             return false;
@@ -77,64 +205,664 @@ namespace
         return true;
     }
 
+    void init_commands()
+    {
+        const cpputils::TraceSpan span{"init_commands"};
+        add_command("hlds_framestats", "Print the server loop timings; 'reset' clears them.", &frame_stats_command);
+#ifndef _WIN32
+        add_command("hlds_poolstats", "Print the pool allocator usage; 'trim' releases the free spans.",
+          &pool_stats_command);
+        add_command("hlds_heapprofile", "Print the sampled heap usage per module; 'reset' clears the rates.",
+          &heap_profile_command);
+#endif
+    }
+
+    /**
+     * @brief Starts the startup trace if requested with -tracestartup.
+     */
+    void start_startup_trace(const CommandLine& cmdline)
+    {
+        if (std::string path{}; cmdline.find_param("-tracestartup", path)) {
+            if (path.empty()) {
+                TextConsole::print("WARNING! -tracestartup: Trace file is not specified.\n");
+            }
+            else {
+                cpputils::get_tracer().start(std::move(path));
+            }
+        }
+    }
+
+    /**
+     * @brief Writes the startup trace; the server loop is not traced.
+     */
+    void stop_startup_trace()
+    {
+        if (auto& tracer = cpputils::get_tracer(); tracer.enabled() && (!tracer.stop())) {
+            TextConsole::print("WARNING! -tracestartup: Unable to write the trace file.\n");
+        }
+    }
+
+#ifndef _WIN32
+    /**
+     * @brief Enables the pool allocator if requested with -poolalloc, before the modules are loaded.
+     */
+    void enable_pool_allocator(const CommandLine& cmdline)
+    {
+        std::string value{};
+
+        if (!cmdline.find_param("-poolalloc", value)) {
+            return;
+        }
+
+        constexpr std::size_t megabyte = 1024 * 1024;
+        std::size_t size = 256;
+
+        if (!value.empty()) {
+            size = std::max(std::strtoul(value.c_str(), nullptr, 10), 1UL);
+        }
+
+        auto& pool = get_pool_allocator();
+
+        if (!pool.enable(size * megabyte)) {
+            TextConsole::print("WARNING! -poolalloc {}: Unable to reserve the pool.\n", size);
+            return;
+        }
+
+        pool.set_trim_on_map_change(cmdline.find_param("-pooltrim"));
+        TextConsole::print("Pool allocator: {} MB reserved.\n", size);
+    }
+
+    /**
+     * @brief Starts the heap profiler if requested with -heapprofile, before the modules are loaded.
+     */
+    void enable_heap_profiler(const CommandLine& cmdline)
+    {
+        std::string value{};
+
+        if (!cmdline.find_param("-heapprofile", value)) {
+            return;
+        }
+
+        constexpr std::size_t kilobyte = 1024;
+        std::size_t interval = 512;
+
+        if (!value.empty()) {
+            interval = std::max(std::strtoul(value.c_str(), nullptr, 10), 1UL);
+        }
+
+        get_heap_profiler().enable(interval * kilobyte);
+        TextConsole::print("Heap profiler: a sample per {} KB allocated.\n", interval);
+    }
+
+    /**
+     * @brief Starts reading the modules and the files listed with -prewarm into the page cache.
+     *
+     * The modules are still loaded one after another: the dynamic loader serializes \c dlopen
+     * and the engine depends on the filesystem initialization order, so only the I/O is overlapped.
+     */
+    void start_prewarm(const CommandLine& cmdline)
+    {
+        if (std::string list_file{}; cmdline.find_param("-prewarm", list_file)) {
+            get_prewarmer().start(prewarm_paths(cmdline, list_file));
+        }
+    }
+
+    /**
+     * @brief Starts watching the server loop for stalls if requested with -stallwatchdog.
+     */
+    void start_stall_watchdog(const CommandLine& cmdline)
+    {
+        std::string value{};
+
+        if (!cmdline.find_param("-stallwatchdog", value)) {
+            return;
+        }
+
+        std::int64_t threshold = 100;
+
+        if (!value.empty()) {
+            threshold = std::max(std::strtoll(value.c_str(), nullptr, 10), 1LL);
+        }
+
+        std::string log_path{"stall.log"};
+
+        if (std::string path{}; cmdline.find_param("-stalllog", path) && (!path.empty())) {
+            log_path = std::move(path);
+        }
+
+        if (!get_stall_watchdog().start(threshold * NANOSECONDS_PER_MILLISECOND, log_path)) {
+            TextConsole::print("WARNING! -stallwatchdog: Unable to install the stack capture signal handler.\n");
+            return;
+        }
+
+        TextConsole::print("Stall watchdog: frames longer than {} ms are logged to \"{}\".\n", threshold, log_path);
+    }
+
+    /**
+     * @brief Starts slowing the empty server down if requested with -idlesleep.
+     */
+    void start_idle_governor(const CommandLine& cmdline)
+    {
+        std::string value{};
+
+        if (!cmdline.find_param("-idlesleep", value)) {
+            return;
+        }
+
+        std::int64_t sleep_time = 100;
+
+        if (!value.empty()) {
+            sleep_time = std::max(std::strtoll(value.c_str(), nullptr, 10), 1LL);
+        }
+
+        // The engine answers the clients and the queries on the same socket
+        auto port = 27015L;
+
+        if (std::string server_port{}; cmdline.find_param("\\+port", server_port) && (!server_port.empty())) {
+            port = std::strtol(server_port.c_str(), nullptr, 10);
+        }
+
+        if ((port <= 0) || (port > 65535)) {
+            TextConsole::print("WARNING! -idlesleep: Invalid server port {}.\n", port);
+            return;
+        }
+
+        get_idle_governor().start(sleep_time * NANOSECONDS_PER_MILLISECOND, static_cast<std::uint16_t>(port));
+        TextConsole::print("Idle governor: the empty server sleeps up to {} ms between frames.\n", sleep_time);
+    }
+#endif
+
+    /* Number of the sleeps sized by the next-frame delay the engine reported. */
+    std::uint64_t adaptive_sleeps = 0;
+
+    /* Number of the sleeps skipped because the engine reported pending network input. */
+    std::uint64_t skipped_sleeps = 0;
+
+    /* Number of the sleeps skipped since the last sleep. */
+    std::uint64_t consecutive_skipped_sleeps = 0;
+
+    /* Most sleeps skipped in a row before the fixed-length sleep runs anyway. */
+    constexpr std::uint64_t MAX_CONSECUTIVE_SKIPPED_SLEEPS = 8;
+
+    /**
+     * @brief Returns the engine interface reporting the next-frame delay, if the engine exposes it and the sleep
+     * mode can use it; otherwise the launcher keeps the fixed-length sleep of \c VENGINE_HLDS_API_VERSION002.
+     */
+    [[nodiscard]] IDedicatedServerApiEx* get_engine_api_ex()
+    {
+        if (!sleep_adaptive) {
+            return nullptr;
+        }
+
+        return get_engine_module().get_interface<IDedicatedServerApiEx>(INTERFACE_DEDICATED_SERVER_API_EX);
+    }
+
+    /**
+     * @brief Sleeps until the engine's next frame is due, or not at all if network input is pending.
+     */
+    void sleep_adaptive_frame(IDedicatedServerApiEx& engine_api, const std::int64_t now)
+    {
+        EngineFrameState state{};
+        engine_api.get_frame_state(&state);
+
+        if (0 != state.network_pending) {
+            if (consecutive_skipped_sleeps < MAX_CONSECUTIVE_SKIPPED_SLEEPS) {
+                ++skipped_sleeps;
+                ++consecutive_skipped_sleeps;
+                sleep_deadline = now;
+                return;
+            }
+
+            // Input the engine keeps reporting but never reads must not spin the server loop
+            consecutive_skipped_sleeps = 0;
+            sys_sleep();
+            return;
+        }
+
+        consecutive_skipped_sleeps = 0;
+        ++adaptive_sleeps;
+        sleep_deadline = now + std::clamp(state.next_frame_delay, std::int64_t{0}, MAX_ADAPTIVE_SLEEP);
+        sleep_until(sleep_deadline);
+    }
+
+    /**
+     * @brief Sleeps before the next frame as the engine asks, or with the sleep of the -pingboost mode.
+     */
+    void sleep_frame(IDedicatedServerApiEx* const engine_api_ex, const std::int64_t now)
+    {
+        if (nullptr == engine_api_ex) {
+            sys_sleep();
+        }
+        else {
+            sleep_adaptive_frame(*engine_api_ex, now);
+        }
+    }
+
     /**
      * @brief Server loop.
+     *
+     * @param engine_api_ex Extended engine interface sizing the sleep, or \c nullptr for the fixed-length sleep.
      */
-    ATTR_OPTIMIZE_HOT NO_INLINE void run_server(IDedicatedServerApi* const engine_api)
+    ATTR_OPTIMIZE_HOT NO_INLINE void run_server(
+      IDedicatedServerApi* const engine_api, IDedicatedServerApiEx* const engine_api_ex)
     {
         assert(engine_api);
 
         std::string text{};
         auto& console = TextConsole::instance();
+        auto& stats = get_frame_stats();
+        auto frame_end = clock_now();
+        auto running = true;
 
-        do {
+#ifndef _WIN32
+        auto& watchdog = get_stall_watchdog();
+        const auto watched = watchdog.enabled();
+        auto& governor = get_idle_governor();
+        const auto governed = governor.enabled();
+        const auto& game_check = get_game_module_check();
+#endif
+
+        while (running) {
             if (console.get_line(text) && (!text.empty())) {
-                text.push_back('\n');
-                engine_api->add_console_text(text.c_str());
+#ifndef _WIN32
+                if (watched) {
+                    watchdog.record_input(text);
+                }
+#endif
+
+                if (!execute_command(text)) {
+                    text.push_back('\n');
+                    engine_api->add_console_text(text.c_str());
+                }
+            }
+
+#ifndef _WIN32
+            if (game_check.finished()) {
+                apply_game_module_check();
             }
+#endif
 
-#ifdef _WIN32
             console.update_status();
+            const auto sleep_start = clock_now();
+            stats.console_input.record(sleep_start - frame_end);
+
+#ifndef _WIN32
+            watchdog.idle();
 #endif
-            sys_sleep();
+
+            sleep_deadline = 0;
+
+#ifndef _WIN32
+            if (governed) {
+                governor.update(sleep_start);
+            }
+
+            if (governed && governor.idle()) {
+                sleep_deadline = governor.sleep(sleep_start);
+            }
+            else {
+                sleep_frame(engine_api_ex, sleep_start);
+            }
+#else
+            sleep_frame(engine_api_ex, sleep_start);
+#endif
+
+            const auto frame_start = clock_now();
+
+#ifndef _WIN32
+            // The heartbeat: the console processing after the frame counts towards the frame
+            watchdog.busy(frame_start);
+#endif
+            const auto wake_deadline = 0 == sleep_deadline ? sleep_start + sleep_duration : sleep_deadline;
+            stats.sleep.record(frame_start - sleep_start);
+            stats.sleep_overshoot.record(frame_start - wake_deadline);
+
+            running = engine_api->run_frame() && (!restart_requested);
+
+            frame_end = clock_now();
+            stats.run_frame.record(frame_end - frame_start);
+        }
+
+#ifndef _WIN32
+        watchdog.idle();
+#endif
+    }
+
+#ifndef _WIN32
+    void report_frame_pacer()
+    {
+        const auto& stats = get_frame_pacer().stats();
+        const auto frames = static_cast<double>(std::max(stats.frames, std::uint64_t{1}));
+        const auto misses = static_cast<double>(stats.misses);
+
+        TextConsole::print("Frame pacer: {} frames, {} deadline misses ({:.3f}%), {} oversleeps, "
+                           "average lateness {:.3f} ms, max lateness {:.3f} ms.\n",
+          stats.frames, stats.misses, misses * 100.0 / frames, stats.oversleeps,
+          to_milliseconds(stats.total_lateness) / std::max(misses, 1.0), to_milliseconds(stats.max_lateness));
+    }
+
+    void report_frame_timer()
+    {
+        const auto& stats = get_frame_timer().stats();
+        const auto wakeups = static_cast<double>(std::max(stats.wakeups, std::uint64_t{1}));
+
+        TextConsole::print("Frame timer: {} ticks, {} missed ticks, {} descriptor wake-ups, "
+                           "average wake-up latency {:.3f} ms, max wake-up latency {:.3f} ms.\n",
+          stats.ticks, stats.missed_ticks, stats.descriptor_wakeups, to_milliseconds(stats.total_latency) / wakeups,
+          to_milliseconds(stats.max_latency));
+    }
+#endif
+
+    void report_sleep_stats()
+    {
+        if ((0 != adaptive_sleeps) || (0 != skipped_sleeps)) {
+            TextConsole::print("Adaptive sleep: {} sleeps sized by the engine, {} skipped for pending network input.\n",
+              adaptive_sleeps, skipped_sleeps);
+        }
+
+#ifndef _WIN32
+        if (&sleep_pacer == sys_sleep) {
+            report_frame_pacer();
+        }
+        else if (&sleep_frame_timer == sys_sleep) {
+            report_frame_timer();
+            get_frame_timer().stop();
+        }
+
+        if (auto& governor = get_idle_governor(); governor.enabled()) {
+            governor.stop();
+            governor.print_status();
+        }
+#endif
+    }
+
+    /**
+     * @brief Initializes the engine and runs the server loop until the engine quits or is restarted.
+     *
+     * @param restart_start Time the restart of the engine started, zero on the first start.
+     *
+     * @return \c true if the engine was initialized and run, otherwise \c false
+     */
+    bool run_engine(const CommandLine& cmdline, IDedicatedServerApi* const engine_api, TextConsole& console,
+      const std::int64_t restart_start)
+    {
+        auto* const launcher_factory = get_factory_this();
+        auto* const filesystem_factory = get_filesystem_module().get_factory();
+        const auto* const current_cmdline = cmdline.current().c_str();
+
+        if ((!init_engine(engine_api, current_cmdline, launcher_factory, filesystem_factory)) ||
+            (!init_console(console))) {
+            return false;
+        }
+
+        {
+            const cpputils::TraceSpan span{"process_post_init_arguments"};
+            process_post_init_arguments(cmdline);
+        }
+
+        init_commands();
+        add_command("hlds_restart", "Restart the engine in place; the arguments update the command line.",
+          &restart_command);
+        stop_startup_trace();
+
+#ifndef _WIN32
+        // The profiler samples the calling thread, so it is only offered to the server loop
+        add_command("hlds_profile", "Sample the server thread stacks; 'start [hz] [seconds] [file]' or 'stop'.",
+          &profile_command);
+        add_command("hlds_idle", "Print the idle governor state and the idle time of the empty server.",
+          &idle_command);
+        add_command("hlds_gamereload", "Reload the game module and the map; a file argument replaces the module.",
+          &game_reload_command);
+        get_sampling_profiler().set_game_module(game_module_path(cmdline));
+        start_stall_watchdog(cmdline);
+        start_idle_governor(cmdline);
+#endif
+
+        if (0 != restart_start) {
+            TextConsole::print("Engine restarted in {:.1f} ms.\n", to_milliseconds(clock_now() - restart_start));
+        }
+
+        auto* const engine_api_ex = get_engine_api_ex();
+        adaptive_sleeps = 0;
+        skipped_sleeps = 0;
+        consecutive_skipped_sleeps = 0;
+
+        if (nullptr != engine_api_ex) {
+            TextConsole::print("The engine exposes \"{}\", the sleep is sized by its next-frame delay.\n",
+              INTERFACE_DEDICATED_SERVER_API_EX);
+        }
+
+        run_server(engine_api, engine_api_ex);
+
+        engine_api->shutdown();
+        report_sleep_stats();
+
+        return true;
+    }
+
+    /**
+     * @brief Unloads and loads the engine module again; the filesystem module stays loaded and mounted.
+     *
+     * @return The engine API of the loaded module, or \c nullptr if it failed to load.
+     */
+    [[nodiscard]] IDedicatedServerApi* reload_engine(const CommandLine& cmdline)
+    {
+        const cpputils::TraceSpan span{"reload_engine"};
+        auto& engine_module = get_engine_module();
+        engine_module.unload();
+
+#ifndef _WIN32
+        // dlclose() keeps a module that is still referenced, e.g. by a plugin, or that has unique symbols
+        const auto path = cpputils::get_module_absolute_path(ENGINE_MODULE_FILE);
+
+        if (auto* const handle = ::dlopen(path.c_str(), RTLD_NOW | RTLD_NOLOAD); nullptr != handle) {
+            TextConsole::print("WARNING! hlds_restart: The engine module stayed loaded, its static data is reused.\n");
+            ::dlclose(handle);
+        }
+#endif
+
+        if (!engine_module.load()) {
+            TextConsole::print("Unable to load engine module, image is corrupt.\n");
+            return nullptr;
+        }
+
+        report_missing_exports();
+
+        auto* const engine_api = get_engine_api(engine_module);
+
+        if (nullptr != engine_api) {
+            process_engine_arguments(cmdline);
+        }
+
+        return engine_api;
+    }
+
+    /**
+     * @brief Runs a server instance with the loaded modules and the mounted filesystem.
+     *
+     * \c hlds_restart ends the server loop, shuts the engine down and loads its module again, then
+     * initializes it with the updated command line. The filesystem stays mounted and the console,
+     * the logs and the launcher threads keep running, so the restart takes the engine initialization only.
+     */
+    int run_instance(const CommandLine& cmdline, IDedicatedServerApi* engine_api, IFileSystem* const filesystem)
+    {
+        {
+            const cpputils::TraceSpan span{"process_cmdline_arguments"};
+            process_cmdline_arguments(cmdline);
         }
-        while (engine_api->run_frame());
+
+        auto& console = TextConsole::instance();
+        auto instance_cmdline = cmdline;
+        std::int64_t restart_start = 0;
+
+        while (run_engine(instance_cmdline, engine_api, console, restart_start) && restart_requested) {
+            restart_start = clock_now();
+            restart_requested = false;
+
+            if (!restart_params.empty()) {
+                instance_cmdline.create(instance_cmdline.current() + ' ' + restart_params);
+            }
+
+#ifndef _WIN32
+            if (!game_module_update.empty()) {
+                if (const auto destination = game_module_path(instance_cmdline); destination.empty()) {
+                    TextConsole::print("WARNING! hlds_gamereload: No gamedll_linux in the liblist.gam of the game.\n");
+                }
+                else {
+                    install_game_module(game_module_update, destination);
+                }
+
+                game_module_update.clear();
+            }
+#endif
+
+            engine_api = reload_engine(instance_cmdline);
+
+            if (nullptr == engine_api) {
+                break;
+            }
+        }
+
+        stop_startup_trace();
+
+#ifndef _WIN32
+        get_stall_watchdog().stop();
+        get_sampling_profiler().stop();
+        get_game_module_check().stop();
+        get_prewarmer().stop();
+        get_status_publisher().close();
+#endif
+
+        filesystem->unmount();
+        console.terminate();
+        get_console_log().close();
+        get_output_writer().stop();
+
+        return 0;
     }
+
+#ifndef _WIN32
+    /**
+     * @brief Serves the zygote control socket; the forked children continue as server instances.
+     *
+     * The engine is initialized by each instance: its initialization opens the sockets and
+     * executes the instance configuration, so only the loaded modules are shared.
+     */
+    int run_zygote(const std::string& socket_path, const CommandLine& cmdline, IDedicatedServerApi* const engine_api,
+      IFileSystem* const filesystem)
+    {
+        // The threads of the zygote are not inherited by the forked instances
+        auto& prewarmer = get_prewarmer();
+        prewarmer.wait();
+
+        if (0 != prewarmer.files()) {
+            TextConsole::print("Zygote: read ahead {} files, {} KB.\n", prewarmer.files(), prewarmer.bytes() / 1024);
+        }
+
+        const auto warmed = warm_module_pages();
+        TextConsole::print("Zygote: prefaulted {} KB of module pages.\n", warmed / 1024);
+
+        // The instances trace nothing; the trace covers the zygote startup
+        stop_startup_trace();
+
+        Zygote zygote{};
+        CommandLine instance_cmdline{};
+
+        if (!zygote.open(socket_path)) {
+            filesystem->unmount();
+            return -1;
+        }
+
+        if (zygote.serve(cmdline, instance_cmdline)) {
+            return run_instance(instance_cmdline, engine_api, filesystem);
+        }
+
+        filesystem->unmount();
+
+        return 0;
+    }
+
+    /**
+     * @brief Hosts the servers listed in the host file, each in its own link-map namespace and thread.
+     */
+    int run_host(const CommandLine& cmdline, const std::string& filename)
+    {
+        auto& host = get_server_host();
+
+        if (!host.load(cmdline, filename)) {
+            stop_startup_trace();
+            return -1;
+        }
+
+        process_cmdline_arguments(cmdline);
+
+        // The engine modules of the base namespace are never loaded
+        auto& console = TextConsole::instance();
+        console.detach_engine();
+
+        if (init_console(console)) {
+            init_commands();
+            add_command("hlds_servers", "Print the state and the timings of the hosted servers.", &servers_command);
+            host.start();
+            stop_startup_trace();
+            host.run();
+            host.stop();
+        }
+
+        stop_startup_trace();
+        get_prewarmer().stop();
+        get_status_publisher().close();
+        console.terminate();
+        get_console_log().close();
+        get_output_writer().stop();
+
+        return 0;
+    }
+#endif
 }
 
 namespace rehlds::dedicated
 {
     int start_hlds(const CommandLine& cmdline)
     {
+        start_startup_trace(cmdline);
+
+#ifndef _WIN32
+        enable_pool_allocator(cmdline);
+        enable_heap_profiler(cmdline);
+        start_prewarm(cmdline);
+
+        if (std::string host_file{}; cmdline.find_param("-hostfile", host_file)) {
+            return run_host(cmdline, host_file);
+        }
+#endif
+
         if (!load_modules()) {
+            stop_startup_trace();
             return -1;
         }
 
-        auto& console = TextConsole::instance();
         auto& engine_module = get_engine_module();
         auto& filesystem_module = get_filesystem_module();
         auto* const engine_api = get_engine_api(engine_module);
         auto* const filesystem = get_filesystem(filesystem_module);
 
         if ((nullptr == engine_api) || (nullptr == filesystem)) {
+            stop_startup_trace();
             return -1;
         }
 
-        filesystem->mount();
-        process_cmdline_arguments(cmdline);
-
-        auto* const launcher_factory = get_factory_this();
-        auto* const filesystem_factory = filesystem_module.get_factory();
-        const auto* const current_cmdline = cmdline.current().c_str();
-
-        if (init_engine(engine_api, current_cmdline, launcher_factory, filesystem_factory) && init_console(console)) {
-            run_server(engine_api);
-            engine_api->shutdown();
+        {
+            const cpputils::TraceSpan span{"mount"};
+            filesystem->mount();
         }
 
-        filesystem->unmount();
-        console.terminate();
+#ifndef _WIN32
+        if (std::string socket_path{}; cmdline.find_param("-zygote", socket_path)) {
+            return run_zygote(socket_path, cmdline, engine_api, filesystem);
+        }
+#endif
 
-        return 0;
+        return run_instance(cmdline, engine_api, filesystem);
     }
 }
@@ -7,6 +7,10 @@
 #include "common/platform.h"
 #include "console/text_console.h"
 
+#ifndef _WIN32
+  #include "server_host.h"
+#endif
+
 using namespace rehlds::common;
 using namespace rehlds::dedicated;
 
@@ -30,7 +34,14 @@ namespace
     void DedicatedExports::print(const char* const text)
     {
         if ((text != nullptr) && (*text != '\0')) {
-            TextConsole::print(text);
+#ifndef _WIN32
+            if (is_hosted_server_thread()) {
+                TextConsole::write(tag_hosted_output(text));
+                return;
+            }
+#endif
+            // The engine text is not a format string
+            TextConsole::write(text);
         }
     }
 }
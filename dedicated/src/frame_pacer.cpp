@@ -0,0 +1,122 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "frame_pacer.h"
+#include "clock.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <ctime>
+#include <immintrin.h>
+
+namespace
+{
+    using namespace rehlds::dedicated;
+
+    /* Number of sleeps used to measure the wake-up slack. */
+    constexpr auto CALIBRATION_SAMPLES = 32;
+
+    /* Duration of each calibration sleep, in nanoseconds. */
+    constexpr std::int64_t CALIBRATION_SLEEP = 100 * NANOSECONDS_PER_MICROSECOND;
+
+    /* Lower bound for the spin-wait margin, in nanoseconds. */
+    constexpr std::int64_t MIN_MARGIN = 20 * NANOSECONDS_PER_MICROSECOND;
+
+    /* Each early wake-up takes back 1/MARGIN_DECAY of the margin grown above the calibrated one. */
+    constexpr std::int64_t MARGIN_DECAY = 16;
+
+    /* Sleeps until the specified absolute time of the monotonic clock. */
+    void sleep_until(const std::int64_t time)
+    {
+        const auto request = to_timespec(time);
+
+        while (EINTR == ::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &request, nullptr)) {
+        }
+    }
+
+    /* Busy-waits until the specified absolute time of the monotonic clock. */
+    void spin_until(const std::int64_t time)
+    {
+        while (clock_now() < time) {
+            _mm_pause();
+        }
+    }
+}
+
+namespace rehlds::dedicated
+{
+    void FramePacer::configure(const double rate, const std::int64_t margin)
+    {
+        assert(rate > 0.0);
+
+        const auto period = static_cast<double>(NANOSECONDS_PER_SECOND) / rate;
+        period_ = std::max(static_cast<std::int64_t>(period), std::int64_t{1});
+        base_margin_ = std::min(margin > 0 ? margin : calibrate_margin(), period_ / 2);
+        margin_ = base_margin_;
+        stats_ = {};
+
+        reset();
+    }
+
+    void FramePacer::wait()
+    {
+        auto now = clock_now();
+
+        if (0 == deadline_) {
+            deadline_ = now;
+        }
+
+        ++stats_.frames;
+
+        if (const auto coarse_deadline = deadline_ - margin_; now < coarse_deadline) {
+            sleep_until(coarse_deadline);
+            now = clock_now();
+
+            // The coarse sleep woke up past the deadline, so the margin is too small for this host;
+            // a single preemption must not keep it large, so it shrinks back while the wake-ups are early
+            if (now > deadline_) {
+                ++stats_.oversleeps;
+                margin_ = std::min(margin_ + (now - deadline_), period_ / 2);
+            }
+            else {
+                margin_ -= (margin_ - base_margin_ + MARGIN_DECAY - 1) / MARGIN_DECAY;
+            }
+        }
+
+        if (now > deadline_) {
+            const auto lateness = now - deadline_;
+            ++stats_.misses;
+            stats_.total_lateness += lateness;
+            stats_.max_lateness = std::max(stats_.max_lateness, lateness);
+
+            // Do not try to catch up with a burst of frames after a long stall
+            if (lateness >= period_) {
+                deadline_ = now;
+            }
+        }
+        else {
+            spin_until(deadline_);
+        }
+
+        deadline_ += period_;
+    }
+
+    std::int64_t FramePacer::calibrate_margin() const
+    {
+        std::array<std::int64_t, CALIBRATION_SAMPLES> slack{};
+
+        for (auto& sample : slack) {
+            const auto start = clock_now();
+            sleep_until(start + CALIBRATION_SLEEP);
+            sample = clock_now() - start - CALIBRATION_SLEEP;
+        }
+
+        // Ignore a single outlier, e.g. caused by a preemption during the calibration
+        std::sort(slack.begin(), slack.end());
+        const auto margin = slack[slack.size() - 2] + MIN_MARGIN;
+
+        return std::clamp(margin, MIN_MARGIN, period_ / 2);
+    }
+}
@@ -0,0 +1,134 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "cpputils/singleton_holder.h"
+#include <cstdint>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Frame pacer statistics.
+     */
+    struct FramePacerStats
+    {
+        /* Number of paced frames. */
+        std::uint64_t frames{};
+
+        /* Number of frames that started after their deadline. */
+        std::uint64_t misses{};
+
+        /* Number of coarse sleeps that woke up after the deadline. */
+        std::uint64_t oversleeps{};
+
+        /* Sum of all deadline misses, in nanoseconds. */
+        std::int64_t total_lateness{};
+
+        /* Largest deadline miss, in nanoseconds. */
+        std::int64_t max_lateness{};
+    };
+
+    /**
+     * @brief Deadline-driven hybrid sleep/spin frame pacer.
+     *
+     * Tracks an absolute next-frame deadline derived from the target frame rate.
+     * Sleeps with \c clock_nanosleep(TIMER_ABSTIME) until only a calibrated margin is left
+     * and spin-waits the rest of the frame period. The margin grows when the sleep wakes up past
+     * the deadline and decays back to the calibrated one while the wake-ups are early.
+     */
+    class FramePacer
+    {
+      public:
+        /**
+         * @brief Sets the target frame rate and the coarse sleep margin.
+         *
+         * @param rate Target frame rate, in frames per second.
+         * @param margin Spin-wait margin, in nanoseconds. Calibrated against the timer slack if zero.
+         */
+        void configure(double rate, std::int64_t margin = 0);
+
+        /**
+         * @brief Waits until the next frame deadline.
+         */
+        void wait();
+
+        /**
+         * @brief Drops the current deadline, the next call to \c wait() starts a new schedule.
+         */
+        void reset() noexcept;
+
+        /**
+         * @brief Returns the frame period, in nanoseconds.
+         */
+        [[nodiscard]] std::int64_t period() const noexcept;
+
+        /**
+         * @brief Returns the current spin-wait margin, in nanoseconds.
+         */
+        [[nodiscard]] std::int64_t margin() const noexcept;
+
+        /**
+         * @brief Returns the next frame deadline on the monotonic clock, in nanoseconds.
+         */
+        [[nodiscard]] std::int64_t deadline() const noexcept;
+
+        /**
+         * @brief Returns the statistics measured since the last \c configure() call.
+         */
+        [[nodiscard]] const FramePacerStats& stats() const noexcept;
+
+      private:
+        /* Frame period, in nanoseconds. */
+        std::int64_t period_{1'000'000};
+
+        /* Part of the frame period that is spin-waited, in nanoseconds. */
+        std::int64_t margin_{};
+
+        /* Configured or calibrated margin the grown margin decays back to, in nanoseconds. */
+        std::int64_t base_margin_{};
+
+        /* Absolute next-frame deadline, in nanoseconds. */
+        std::int64_t deadline_{};
+
+        /* Measured statistics. */
+        FramePacerStats stats_{};
+
+        /* Measures the scheduler wake-up slack of the coarse sleep. */
+        [[nodiscard]] std::int64_t calibrate_margin() const;
+    };
+
+    inline void FramePacer::reset() noexcept
+    {
+        deadline_ = 0;
+    }
+
+    inline std::int64_t FramePacer::period() const noexcept
+    {
+        return period_;
+    }
+
+    inline std::int64_t FramePacer::margin() const noexcept
+    {
+        return margin_;
+    }
+
+    inline std::int64_t FramePacer::deadline() const noexcept
+    {
+        return deadline_;
+    }
+
+    inline const FramePacerStats& FramePacer::stats() const noexcept
+    {
+        return stats_;
+    }
+
+    /**
+     * @brief Returns a frame pacer instance.
+     */
+    [[nodiscard]] inline FramePacer& get_frame_pacer()
+    {
+        return cpputils::SingletonHolder<FramePacer>::get_instance();
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "frame_stats.h"
+#include "clock.h"
+#include "console/output_writer.h"
+#include "console/text_console.h"
+#include "cpputils/format.h"
+#include "cpputils/string.h"
+#include <cstdint>
+
+using namespace rehlds::dedicated;
+
+namespace
+{
+    [[nodiscard]] double milliseconds(const std::uint64_t nanoseconds)
+    {
+        return to_milliseconds(static_cast<std::int64_t>(nanoseconds));
+    }
+
+    void print_histogram(const std::string& name, const Histogram& histogram)
+    {
+        const auto summary = histogram.summary();
+
+        TextConsole::print("{:<18}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}{:>14}\n", name, milliseconds(summary.p50),
+          milliseconds(summary.p99), milliseconds(summary.p999), milliseconds(summary.max), summary.count);
+    }
+}
+
+namespace rehlds::dedicated
+{
+    void FrameStats::reset() noexcept
+    {
+        run_frame.reset();
+        sleep.reset();
+        sleep_overshoot.reset();
+        console_input.reset();
+    }
+
+    void print_frame_stats()
+    {
+        const auto& stats = get_frame_stats();
+
+        TextConsole::print("{:<18}{:>10}{:>10}{:>10}{:>10}{:>14}\n", "Timings (ms)", "p50", "p99", "p99.9", "max",
+          "count");
+
+        print_histogram("run_frame", stats.run_frame);
+        print_histogram("sleep", stats.sleep);
+        print_histogram("sleep overshoot", stats.sleep_overshoot);
+        print_histogram("console input", stats.console_input);
+
+        if (const auto& writer = get_output_writer(); writer.dropped_messages() > 0) {
+            TextConsole::print("Console output dropped: {} messages, {} bytes.\n", writer.dropped_messages(),
+              writer.dropped_bytes());
+        }
+    }
+
+    std::string frame_stats_status()
+    {
+        const auto summary = get_frame_stats().run_frame.summary();
+
+        return cpputils::format("Frame p99/max: {:.2f}/{:.2f} ms", milliseconds(summary.p99), milliseconds(summary.max));
+    }
+
+    void frame_stats_command(const std::string& args)
+    {
+        if (cpputils::equal_ignore_case(args, "reset")) {
+            get_frame_stats().reset();
+            TextConsole::print("Frame statistics reset.\n");
+        }
+        else {
+            print_frame_stats();
+        }
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "histogram.h"
+#include "cpputils/singleton_holder.h"
+#include <string>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Timings of the launcher server loop, in nanoseconds.
+     */
+    struct FrameStats
+    {
+        /* Duration of IDedicatedServerApi::run_frame(). */
+        Histogram run_frame{};
+
+        /* Time spent in sys_sleep(). */
+        Histogram sleep{};
+
+        /* Time sys_sleep() returned after the wake-up it was asked for. */
+        Histogram sleep_overshoot{};
+
+        /* Time spent polling the console for input. */
+        Histogram console_input{};
+
+        /**
+         * @brief Clears all histograms. Must be called by the server thread.
+         */
+        void reset() noexcept;
+    };
+
+    /**
+     * @brief Returns the server loop timings instance.
+     */
+    [[nodiscard]] inline FrameStats& get_frame_stats()
+    {
+        return cpputils::SingletonHolder<FrameStats>::get_instance();
+    }
+
+    /**
+     * @brief Prints the percentiles of the server loop timings to the console.
+     */
+    void print_frame_stats();
+
+    /**
+     * @brief Returns a short frame time summary for the console status line.
+     */
+    [[nodiscard]] std::string frame_stats_status();
+
+    /**
+     * @brief Handler of the \c hlds_framestats console command.
+     */
+    void frame_stats_command(const std::string& args);
+}
@@ -0,0 +1,136 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "frame_timer.h"
+#include "clock.h"
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <unistd.h>
+
+namespace
+{
+    /* Maximum number of events returned by a single wait. */
+    constexpr auto MAX_EVENTS = 8;
+
+    [[nodiscard]] bool watch_descriptor(const int epoll_fd, const int descriptor, const std::uint32_t events)
+    {
+        ::epoll_event event{};
+        event.events = events;
+        event.data.fd = descriptor;
+
+        return (epoll_fd >= 0) && (0 == ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, descriptor, &event));
+    }
+
+    void close_descriptor(int& descriptor) noexcept
+    {
+        if (descriptor >= 0) {
+            ::close(descriptor);
+            descriptor = -1;
+        }
+    }
+}
+
+namespace rehlds::dedicated
+{
+    bool FrameTimer::start(const double rate)
+    {
+        assert(rate > 0.0);
+        stop();
+
+        timer_fd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+
+        if ((timer_fd_ < 0) || (epoll_fd_ < 0) || (!watch_descriptor(epoll_fd_, timer_fd_, EPOLLIN))) {
+            stop();
+            return false;
+        }
+
+        const auto period = static_cast<double>(NANOSECONDS_PER_SECOND) / rate;
+        period_ = std::max(static_cast<std::int64_t>(period), std::int64_t{1});
+        start_time_ = clock_now() + period_;
+        expirations_ = 0;
+        stats_ = {};
+
+        ::itimerspec timer_spec{};
+        timer_spec.it_interval = to_timespec(period_);
+        timer_spec.it_value = to_timespec(start_time_);
+
+        if (0 != ::timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &timer_spec, nullptr)) {
+            stop();
+            return false;
+        }
+
+        return true;
+    }
+
+    void FrameTimer::stop() noexcept
+    {
+        close_descriptor(epoll_fd_);
+        close_descriptor(timer_fd_);
+    }
+
+    bool FrameTimer::add_descriptor(const int descriptor)
+    {
+        // The timer never reads the descriptor, so only new input may end a wait
+        return watch_descriptor(epoll_fd_, descriptor, EPOLLIN | EPOLLET);
+    }
+
+    bool FrameTimer::remove_descriptor(const int descriptor)
+    {
+        return (epoll_fd_ >= 0) && (0 == ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, descriptor, nullptr));
+    }
+
+    bool FrameTimer::wait(const int timeout)
+    {
+        std::array<::epoll_event, MAX_EVENTS> events{};
+        auto ready = ::epoll_wait(epoll_fd_, events.data(), MAX_EVENTS, timeout);
+
+        while ((ready < 0) && (EINTR == errno)) {
+            ready = ::epoll_wait(epoll_fd_, events.data(), MAX_EVENTS, timeout);
+        }
+
+        auto expired = false;
+        const auto now = clock_now();
+
+        for (auto i = 0; i < ready; ++i) {
+            if (timer_fd_ == events[static_cast<std::size_t>(i)].data.fd) {
+                read_expirations(now);
+                expired = true;
+            }
+        }
+
+        if ((ready > 0) && (!expired)) {
+            ++stats_.descriptor_wakeups;
+        }
+
+        return expired;
+    }
+
+    void FrameTimer::read_expirations(const std::int64_t now)
+    {
+        std::uint64_t count = 0;
+
+        if ((::read(timer_fd_, &count, sizeof(count)) != static_cast<::ssize_t>(sizeof(count))) || (0 == count)) {
+            return;
+        }
+
+        expirations_ += count;
+        ++stats_.wakeups;
+        stats_.ticks += count;
+        stats_.missed_ticks += count - 1;
+
+        // Latency relative to the most recent expiration of the periodic schedule
+        const auto expiration_time = start_time_ + static_cast<std::int64_t>(expirations_ - 1) * period_;
+        const auto latency = std::max(now - expiration_time, std::int64_t{0});
+
+        stats_.total_latency += latency;
+        stats_.max_latency = std::max(stats_.max_latency, latency);
+    }
+}
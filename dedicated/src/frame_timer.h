@@ -0,0 +1,162 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "cpputils/singleton_holder.h"
+#include <cstdint>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Frame timer statistics.
+     */
+    struct FrameTimerStats
+    {
+        /* Number of timer expirations consumed by the waits. */
+        std::uint64_t ticks{};
+
+        /* Number of expirations that passed while the frame was still running. */
+        std::uint64_t missed_ticks{};
+
+        /* Number of wake-ups that consumed timer expirations. */
+        std::uint64_t wakeups{};
+
+        /* Number of wake-ups caused by the registered descriptors. */
+        std::uint64_t descriptor_wakeups{};
+
+        /* Sum of the latencies of the timer wake-ups, in nanoseconds. */
+        std::int64_t total_latency{};
+
+        /* Largest timer wake-up latency, in nanoseconds. */
+        std::int64_t max_latency{};
+    };
+
+    /**
+     * @brief Periodic frame timer backed by a \c timerfd registered in an \c epoll set.
+     *
+     * The timer is armed once with the frame period, so each wait costs a single \c epoll_wait()
+     * and a \c read() of the expiration counter. Additional descriptors (e.g. sockets) can be
+     * registered in the same set to wake up the server loop before the next tick.
+     */
+    class FrameTimer
+    {
+      public:
+        FrameTimer() = default;
+        FrameTimer(FrameTimer&&) = delete;
+        FrameTimer(const FrameTimer&) = delete;
+        FrameTimer& operator=(FrameTimer&&) = delete;
+        FrameTimer& operator=(const FrameTimer&) = delete;
+        ~FrameTimer();
+
+        /**
+         * @brief Creates the timer and arms it with the specified frame rate.
+         *
+         * @return \c true if the timer was armed successfully, otherwise \c false
+         */
+        bool start(double rate);
+
+        /**
+         * @brief Disarms the timer and releases the descriptors.
+         */
+        void stop() noexcept;
+
+        /**
+         * @brief Returns true if the timer is armed.
+         */
+        [[nodiscard]] bool started() const noexcept;
+
+        /**
+         * @brief Registers a descriptor whose new input interrupts the wait.
+         *
+         * The descriptor is edge-triggered: unread input that was already reported does not end
+         * the following waits, so the owner of the descriptor need not drain it every frame.
+         */
+        bool add_descriptor(int descriptor);
+
+        /**
+         * @brief Unregisters a descriptor added with \c add_descriptor().
+         */
+        bool remove_descriptor(int descriptor);
+
+        /**
+         * @brief Waits for the next timer expiration or for a registered descriptor.
+         *
+         * @param timeout Maximum wait time in milliseconds, or -1 to wait for the next tick.
+         *
+         * @return \c true if the timer has expired, otherwise \c false
+         */
+        bool wait(int timeout = -1);
+
+        /**
+         * @brief Returns the frame period, in nanoseconds.
+         */
+        [[nodiscard]] std::int64_t period() const noexcept;
+
+        /**
+         * @brief Returns the time of the next expected expiration on the monotonic clock, in nanoseconds.
+         */
+        [[nodiscard]] std::int64_t next_expiration() const noexcept;
+
+        /**
+         * @brief Returns the statistics measured since the last \c start() call.
+         */
+        [[nodiscard]] const FrameTimerStats& stats() const noexcept;
+
+      private:
+        /* Timer descriptor. */
+        int timer_fd_{-1};
+
+        /* Epoll instance descriptor. */
+        int epoll_fd_{-1};
+
+        /* Frame period, in nanoseconds. */
+        std::int64_t period_{};
+
+        /* First expiration time on the monotonic clock, in nanoseconds. */
+        std::int64_t start_time_{};
+
+        /* Number of expirations since the timer was armed. */
+        std::uint64_t expirations_{};
+
+        /* Measured statistics. */
+        FrameTimerStats stats_{};
+
+        /* Consumes the timer expirations and measures the wake-up latency. */
+        void read_expirations(std::int64_t now);
+    };
+
+    inline FrameTimer::~FrameTimer()
+    {
+        stop();
+    }
+
+    inline bool FrameTimer::started() const noexcept
+    {
+        return timer_fd_ >= 0;
+    }
+
+    inline std::int64_t FrameTimer::period() const noexcept
+    {
+        return period_;
+    }
+
+    inline std::int64_t FrameTimer::next_expiration() const noexcept
+    {
+        return start_time_ + (static_cast<std::int64_t>(expirations_) * period_);
+    }
+
+    inline const FrameTimerStats& FrameTimer::stats() const noexcept
+    {
+        return stats_;
+    }
+
+    /**
+     * @brief Returns a frame timer instance.
+     */
+    [[nodiscard]] inline FrameTimer& get_frame_timer()
+    {
+        return cpputils::SingletonHolder<FrameTimer>::get_instance();
+    }
+}
@@ -0,0 +1,124 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "game_reload.h"
+#include "common/hlds_module.h"
+#include "console/text_console.h"
+#include "realtime.h"
+#include <dlfcn.h>
+#include <filesystem>
+#include <pthread.h>
+#include <system_error>
+#include <utility>
+
+using namespace rehlds::common;
+
+namespace rehlds::dedicated
+{
+    bool check_game_module(const std::string& path)
+    {
+        std::error_code error{};
+
+        if (!std::filesystem::is_regular_file(path, error)) {
+            TextConsole::print("WARNING! hlds_gamereload: \"{}\" is not a file.\n", path);
+            return false;
+        }
+
+        HldsModule module{path};
+        ::Lmid_t link_map = LM_ID_NEWLM;
+
+        if (!module.load(link_map)) {
+            TextConsole::print("WARNING! hlds_gamereload: Unable to load \"{}\": {}\n", path, ::dlerror());
+            return false;
+        }
+
+        if (nullptr == module.get_proc_address(GAME_MODULE_ENTRY_PROC_NAME)) {
+            TextConsole::print("WARNING! hlds_gamereload: \"{}\" does not export {}.\n", path,
+              GAME_MODULE_ENTRY_PROC_NAME);
+            return false;
+        }
+
+        return true;
+    }
+
+    GameModuleCheck::~GameModuleCheck()
+    {
+        stop();
+    }
+
+    bool GameModuleCheck::start(std::string path)
+    {
+        if (thread_.joinable()) {
+            return false;
+        }
+
+        path_ = std::move(path);
+        passed_ = false;
+        finished_.store(false, std::memory_order_relaxed);
+        thread_ = std::thread{&GameModuleCheck::run, this};
+
+        return true;
+    }
+
+    bool GameModuleCheck::take_result()
+    {
+        if (!finished()) {
+            return false;
+        }
+
+        thread_.join();
+        finished_.store(false, std::memory_order_relaxed);
+
+        return passed_;
+    }
+
+    void GameModuleCheck::stop()
+    {
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+
+        finished_.store(false, std::memory_order_relaxed);
+    }
+
+    void GameModuleCheck::run()
+    {
+        ::pthread_setname_np(::pthread_self(), "hlds-gamecheck");
+        set_background_thread_policy();
+
+        passed_ = check_game_module(path_);
+        finished_.store(true, std::memory_order_release);
+    }
+
+    bool install_game_module(const std::string& source, const std::string& destination)
+    {
+        std::error_code error{};
+
+        if (std::filesystem::equivalent(source, destination, error)) {
+            return true;
+        }
+
+        // The running instances keep the mapping of the replaced file, which is only unlinked
+        const auto staged = destination + ".new";
+
+        if (!std::filesystem::copy_file(source, staged, std::filesystem::copy_options::overwrite_existing, error)) {
+            TextConsole::print("WARNING! hlds_gamereload: Unable to copy \"{}\": {}\n", source, error.message());
+            return false;
+        }
+
+        std::filesystem::permissions(staged, std::filesystem::status(source, error).permissions(), error);
+        std::filesystem::rename(staged, destination, error);
+
+        if (error) {
+            TextConsole::print("WARNING! hlds_gamereload: Unable to replace \"{}\": {}\n", destination,
+              error.message());
+            std::filesystem::remove(staged, error);
+            return false;
+        }
+
+        TextConsole::print("Game module \"{}\" installed as \"{}\".\n", source, destination);
+
+        return true;
+    }
+}
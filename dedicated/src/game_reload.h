@@ -0,0 +1,117 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "cpputils/singleton_holder.h"
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Name of the function every game module exports to receive the engine functions.
+     */
+    constexpr auto* GAME_MODULE_ENTRY_PROC_NAME = "GiveFnptrsToDll";
+
+    /**
+     * @brief Checks that the file loads as a game module.
+     *
+     * The module is loaded into a new link-map namespace, so it does not collide with the running
+     * game module, and must resolve all its symbols and export \c GiveFnptrsToDll. Its static
+     * constructors run in that namespace, which is unloaded again.
+     *
+     * @return \c true if the module is loadable, otherwise \c false
+     */
+    bool check_game_module(const std::string& path);
+
+    /**
+     * @brief Runs check_game_module() on a background thread, so loading the candidate module and
+     * running its static constructors does not stall the server loop.
+     */
+    class GameModuleCheck
+    {
+      public:
+        GameModuleCheck() = default;
+        GameModuleCheck(GameModuleCheck&&) = delete;
+        GameModuleCheck(const GameModuleCheck&) = delete;
+        GameModuleCheck& operator=(GameModuleCheck&&) = delete;
+        GameModuleCheck& operator=(const GameModuleCheck&) = delete;
+        ~GameModuleCheck();
+
+        /**
+         * @brief Starts checking the file.
+         *
+         * @return \c true if the check was started, \c false if a check is still running
+         */
+        bool start(std::string path);
+
+        /**
+         * @brief Returns true if a check has finished and its result was not taken yet.
+         */
+        [[nodiscard]] bool finished() const noexcept;
+
+        /**
+         * @brief Takes the result of the finished check.
+         *
+         * @return \c true if the module is loadable, otherwise \c false
+         */
+        bool take_result();
+
+        /**
+         * @brief Returns the path of the checked file.
+         */
+        [[nodiscard]] const std::string& path() const noexcept;
+
+        /**
+         * @brief Waits for the running check and drops its result.
+         */
+        void stop();
+
+      private:
+        /* Path of the checked file. */
+        std::string path_{};
+
+        /* Is the module loadable? */
+        bool passed_{};
+
+        /* Has the check finished? */
+        std::atomic<bool> finished_{};
+
+        /* Checking thread. */
+        std::thread thread_{};
+
+        /* Thread entry point. */
+        void run();
+    };
+
+    /**
+     * @brief Replaces the game module the engine loads with the specified file.
+     *
+     * The file is copied next to the destination and renamed over it, so the engine never sees
+     * a partially written module. Must be called while the engine has released the game module.
+     *
+     * @return \c true if the module was installed, otherwise \c false
+     */
+    bool install_game_module(const std::string& source, const std::string& destination);
+
+    /**
+     * @brief Returns a game module check instance.
+     */
+    [[nodiscard]] inline GameModuleCheck& get_game_module_check()
+    {
+        return cpputils::SingletonHolder<GameModuleCheck>::get_instance();
+    }
+
+    inline bool GameModuleCheck::finished() const noexcept
+    {
+        return finished_.load(std::memory_order_acquire);
+    }
+
+    inline const std::string& GameModuleCheck::path() const noexcept
+    {
+        return path_;
+    }
+}
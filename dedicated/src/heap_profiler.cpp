@@ -0,0 +1,398 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "heap_profiler.h"
+#include "common/platform.h"
+#include "console/text_console.h"
+#include "cpputils/string.h"
+#include "symbolizer.h"
+#include <execinfo.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <pthread.h>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+    using rehlds::dedicated::HEAP_PROFILE_FRAMES;
+    using rehlds::dedicated::HEAP_PROFILE_SAMPLES;
+    using rehlds::dedicated::HEAP_PROFILE_SITES;
+    using rehlds::dedicated::HeapProfiler;
+    using rehlds::dedicated::HeapProfileSite;
+    using rehlds::dedicated::Symbol;
+    using rehlds::dedicated::symbolize;
+
+    constexpr double MEGABYTE = 1024.0 * 1024.0;
+
+    /* Frames of the profiler and of the malloc hook on top of a sampled stack. */
+    constexpr std::size_t SKIPPED_FRAMES = 3;
+
+    /* Longest probe sequence in the sample table. */
+    constexpr std::size_t MAX_PROBES = 64;
+
+    /* Marks a freed slot of the sample table. */
+    void* const TOMBSTONE = reinterpret_cast<void*>(std::uintptr_t{1});
+
+    /* Libraries that allocate on behalf of their callers; the allocations are attributed to the caller. */
+    constexpr std::array<std::string_view, 6> PASSTHROUGH_LIBRARIES{
+      "libc.so", "libc-", "libstdc++", "libgcc_s", "ld-linux", "libpthread"};
+
+    /* Process-wide profiler; constant-initialized, so it is usable before the static constructors run. */
+    HeapProfiler heap_profiler{};
+
+    /* Sampling state of a thread. */
+    struct ThreadState
+    {
+        /* Bytes to allocate before the next sample. */
+        std::int64_t bytes_until_sample;
+
+        /* State of the random generator, zero until the first allocation. */
+        std::uint64_t random;
+
+        /* Is the thread taking a sample? */
+        bool sampling;
+    };
+
+    thread_local ThreadState thread_state{};
+
+    [[nodiscard]] std::size_t home_slot(const void* const pointer) noexcept
+    {
+        // Fibonacci hashing spreads the aligned block addresses over the table
+        const auto address = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(pointer));
+        return static_cast<std::size_t>((address * 0x9E3779B97F4A7C15ULL) >> 48) & (HEAP_PROFILE_SAMPLES - 1);
+    }
+
+    /* Returns an exponentially distributed number of bytes with the specified mean. */
+    [[nodiscard]] std::int64_t next_interval(ThreadState& state, const std::size_t mean) noexcept
+    {
+        if (0 == state.random) {
+            state.random = reinterpret_cast<std::uintptr_t>(&state) ^ 0x2545F4914F6CDD1DULL;
+        }
+
+        state.random ^= state.random << 13;
+        state.random ^= state.random >> 7;
+        state.random ^= state.random << 17;
+
+        const auto uniform = static_cast<double>((state.random >> 11) + 1) / 9007199254740992.0;
+        return static_cast<std::int64_t>(-std::log(uniform) * static_cast<double>(mean)) + 1;
+    }
+
+    [[nodiscard]] bool is_passthrough(const std::string_view module)
+    {
+        return std::any_of(PASSTHROUGH_LIBRARIES.cbegin(), PASSTHROUGH_LIBRARIES.cend(),
+          [module](const std::string_view library) { return 0 == module.rfind(library, 0); });
+    }
+
+    /* Returns the call site a sample is attributed to: the first frame outside the passthrough libraries. */
+    [[nodiscard]] Symbol attribute(const HeapProfileSite& site)
+    {
+        Symbol fallback{};
+        auto has_fallback = false;
+
+        for (std::size_t i = 0; i < site.depth; ++i) {
+            Symbol symbol{};
+
+            if (!symbolize(site.frames[i], symbol)) {
+                continue;
+            }
+
+            if (!is_passthrough(symbol.module)) {
+                return symbol;
+            }
+
+            if (!has_fallback) {
+                fallback.module = symbol.module;
+                fallback.location = symbol.module;
+                has_fallback = true;
+            }
+        }
+
+        return fallback;
+    }
+
+    void lock_before_fork() noexcept
+    {
+        heap_profiler.lock_all();
+    }
+
+    void unlock_after_fork() noexcept
+    {
+        heap_profiler.unlock_all();
+    }
+}
+
+namespace rehlds::dedicated
+{
+    void HeapProfiler::enable(const std::size_t interval)
+    {
+        if (enabled()) {
+            return;
+        }
+
+        // The first backtrace loads the unwinder, which allocates
+        std::array<void*, HEAP_PROFILE_FRAMES> frames{};
+        ::backtrace(frames.data(), static_cast<int>(frames.size()));
+
+        ::pthread_atfork(&lock_before_fork, &unlock_after_fork, &unlock_after_fork);
+        interval_ = std::max(interval, std::size_t{1});
+        reset_time_ = std::chrono::steady_clock::now();
+        enabled_.store(true, std::memory_order_release);
+    }
+
+    void HeapProfiler::record_allocation(void* const pointer, const std::size_t size) noexcept
+    {
+        auto& state = thread_state;
+        state.bytes_until_sample -= static_cast<std::int64_t>(size);
+
+        if ((state.bytes_until_sample > 0) || (nullptr == pointer) || state.sampling) {
+            return;
+        }
+
+        // The allocations made while sampling are not sampled
+        state.sampling = true;
+        state.bytes_until_sample = next_interval(state, interval_);
+        sample(pointer, size);
+        state.sampling = false;
+    }
+
+    HeapProfiler::Sample HeapProfiler::record_free(void* const pointer) noexcept
+    {
+        if ((nullptr == pointer) || (0 == filter_[home_slot(pointer)].load(std::memory_order_relaxed))) {
+            return {};
+        }
+
+        const std::lock_guard lock{mutex_};
+        const auto home = home_slot(pointer);
+
+        for (std::size_t probe = 0; probe < MAX_PROBES; ++probe) {
+            auto& slot = samples_[(home + probe) & (HEAP_PROFILE_SAMPLES - 1)];
+
+            if (nullptr == slot.pointer) {
+                return {};
+            }
+
+            if (pointer == slot.pointer) {
+                const auto removed = slot;
+                sites_[slot.site].live_bytes -= slot.weight;
+                slot.pointer = TOMBSTONE;
+                filter_[home].fetch_sub(1, std::memory_order_relaxed);
+                return removed;
+            }
+        }
+
+        return {};
+    }
+
+    void HeapProfiler::restore(const Sample& sample) noexcept
+    {
+        if (nullptr == sample.pointer) {
+            return;
+        }
+
+        const std::lock_guard lock{mutex_};
+        insert(sample);
+    }
+
+    void HeapProfiler::reset() noexcept
+    {
+        const std::lock_guard lock{mutex_};
+
+        for (std::size_t i = 0; i < site_count_; ++i) {
+            sites_[i].allocated_bytes = 0;
+            sites_[i].samples = 0;
+        }
+
+        reset_time_ = std::chrono::steady_clock::now();
+    }
+
+    void HeapProfiler::print_report(const std::size_t top_sites)
+    {
+        if (!enabled()) {
+            TextConsole::print("Heap profiler is disabled, see -heapprofile.\n");
+            return;
+        }
+
+        double elapsed = 0.0;
+        const auto sites = copy_sites(elapsed);
+        const auto minutes = std::max(elapsed / 60.0, 1.0 / 60.0);
+
+        struct Usage
+        {
+            std::string name{};
+            std::uint64_t live_bytes{};
+            std::uint64_t allocated_bytes{};
+        };
+
+        // Stacks that differ below the attributed frame add up to the same call site
+        std::map<std::string, Usage> modules{};
+        std::map<std::string, Usage> call_sites{};
+
+        for (const auto& site : sites) {
+            const auto symbol = attribute(site);
+
+            for (const auto& [usages, name] :
+              {std::pair{&modules, &symbol.module}, std::pair{&call_sites, &symbol.location}}) {
+                auto& usage = (*usages)[*name];
+                usage.name = *name;
+                usage.live_bytes += site.live_bytes;
+                usage.allocated_bytes += site.allocated_bytes;
+            }
+        }
+
+        const auto to_vector = [](std::map<std::string, Usage>& usages)
+        {
+            std::vector<Usage> result{};
+            result.reserve(usages.size());
+
+            for (auto& [name, usage] : usages) {
+                result.push_back(std::move(usage));
+            }
+
+            return result;
+        };
+
+        auto totals = to_vector(modules);
+        auto locations = to_vector(call_sites);
+
+        const auto by_live_bytes = [](const Usage& left, const Usage& right)
+        {
+            return std::tie(left.live_bytes, left.allocated_bytes) > std::tie(right.live_bytes, right.allocated_bytes);
+        };
+
+        std::sort(totals.begin(), totals.end(), by_live_bytes);
+        std::sort(locations.begin(), locations.end(), by_live_bytes);
+
+        TextConsole::print("Heap profile: a sample per {} KB, {} samples, {} dropped, {:.1f} min since reset.\n",
+          interval_ / 1024, sample_count_, dropped_, elapsed / 60.0);
+        TextConsole::print("{:<32}{:>12}{:>14}\n", "Module", "Live MB", "Alloc MB/min");
+
+        for (const auto& usage : totals) {
+            TextConsole::print("{:<32}{:>12.2f}{:>14.2f}\n", usage.name,
+              static_cast<double>(usage.live_bytes) / MEGABYTE,
+              static_cast<double>(usage.allocated_bytes) / MEGABYTE / minutes);
+        }
+
+        TextConsole::print("Top call sites by live bytes:\n");
+
+        for (std::size_t i = 0; i < std::min(top_sites, locations.size()); ++i) {
+            const auto& usage = locations[i];
+            TextConsole::print("  {:.2f} MB live, {:.2f} MB/min: {}\n",
+              static_cast<double>(usage.live_bytes) / MEGABYTE,
+              static_cast<double>(usage.allocated_bytes) / MEGABYTE / minutes, usage.name);
+        }
+    }
+
+    void HeapProfiler::lock_all() noexcept
+    {
+        mutex_.lock();
+    }
+
+    void HeapProfiler::unlock_all() noexcept
+    {
+        mutex_.unlock();
+    }
+
+    NO_INLINE void HeapProfiler::sample(void* const pointer, const std::size_t size) noexcept
+    {
+        std::array<void*, HEAP_PROFILE_FRAMES + SKIPPED_FRAMES> frames{};
+        const auto depth = static_cast<std::size_t>(::backtrace(frames.data(), static_cast<int>(frames.size())));
+
+        if (depth <= SKIPPED_FRAMES) {
+            return;
+        }
+
+        const auto weight = static_cast<std::uint32_t>(
+          std::min<std::size_t>(std::max(size, interval_), std::numeric_limits<std::uint32_t>::max()));
+
+        const std::lock_guard lock{mutex_};
+        ++sample_count_;
+
+        const auto site_index = find_site(frames.data() + SKIPPED_FRAMES, depth - SKIPPED_FRAMES);
+
+        if (HEAP_PROFILE_SITES == site_index) {
+            ++dropped_;
+            return;
+        }
+
+        auto& site = sites_[site_index];
+        site.allocated_bytes += weight;
+        ++site.samples;
+
+        insert({pointer, static_cast<std::uint32_t>(site_index), weight});
+    }
+
+    void HeapProfiler::insert(const Sample& sample) noexcept
+    {
+        const auto home = home_slot(sample.pointer);
+
+        for (std::size_t probe = 0; probe < MAX_PROBES; ++probe) {
+            auto& slot = samples_[(home + probe) & (HEAP_PROFILE_SAMPLES - 1)];
+
+            if ((nullptr == slot.pointer) || (TOMBSTONE == slot.pointer)) {
+                slot = sample;
+                filter_[home].fetch_add(1, std::memory_order_relaxed);
+                sites_[sample.site].live_bytes += sample.weight;
+                return;
+            }
+        }
+
+        ++dropped_;
+    }
+
+    std::size_t HeapProfiler::find_site(void* const* const frames, const std::size_t depth) noexcept
+    {
+        // The sites are few and sampled rarely, a linear search keeps the table simple
+        for (std::size_t i = 0; i < site_count_; ++i) {
+            if ((depth == sites_[i].depth) && std::equal(frames, frames + depth, sites_[i].frames.cbegin())) {
+                return i;
+            }
+        }
+
+        if (HEAP_PROFILE_SITES == site_count_) {
+            return HEAP_PROFILE_SITES;
+        }
+
+        auto& site = sites_[site_count_];
+        std::copy(frames, frames + depth, site.frames.begin());
+        site.depth = depth;
+
+        return site_count_++;
+    }
+
+    std::vector<HeapProfileSite> HeapProfiler::copy_sites(double& elapsed)
+    {
+        // Allocate before locking: the allocations of this thread may be sampled
+        std::vector<HeapProfileSite> sites(HEAP_PROFILE_SITES);
+
+        const std::lock_guard lock{mutex_};
+        sites.resize(site_count_);
+        std::copy(sites_.cbegin(), sites_.cbegin() + static_cast<std::ptrdiff_t>(site_count_), sites.begin());
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - reset_time_).count();
+
+        return sites;
+    }
+
+    HeapProfiler& get_heap_profiler() noexcept
+    {
+        return heap_profiler;
+    }
+
+    void heap_profile_command(const std::string& args)
+    {
+        constexpr std::size_t top_sites = 20;
+
+        if (cpputils::equal_ignore_case(args, "reset")) {
+            get_heap_profiler().reset();
+            TextConsole::print("Heap profile allocation rates reset.\n");
+        }
+        else {
+            get_heap_profiler().print_report(top_sites);
+        }
+    }
+}
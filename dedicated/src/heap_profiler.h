@@ -0,0 +1,189 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Number of the stack frames recorded per call site.
+     */
+    constexpr std::size_t HEAP_PROFILE_FRAMES = 8;
+
+    /**
+     * @brief Maximum number of the distinct call sites.
+     */
+    constexpr std::size_t HEAP_PROFILE_SITES = 4096;
+
+    /**
+     * @brief Maximum number of the sampled allocations tracked until they are freed.
+     */
+    constexpr std::size_t HEAP_PROFILE_SAMPLES = 65536;
+
+    /**
+     * @brief Sampled allocations of a call site.
+     */
+    struct HeapProfileSite
+    {
+        /* Return addresses of the stack, starting at the caller of malloc. */
+        std::array<void*, HEAP_PROFILE_FRAMES> frames{};
+
+        /* Number of the recorded frames. */
+        std::size_t depth{};
+
+        /* Estimated bytes allocated by the site and not freed yet. */
+        std::uint64_t live_bytes{};
+
+        /* Estimated bytes allocated by the site since the last reset. */
+        std::uint64_t allocated_bytes{};
+
+        /* Number of the samples taken at the site since the last reset. */
+        std::uint64_t samples{};
+    };
+
+    /**
+     * @brief Sampling heap profiler fed by the launcher \c malloc.
+     *
+     * An allocation is sampled each time the allocated bytes of the thread pass a random
+     * threshold, exponentially distributed around the sampling interval, so the overhead is
+     * bounded by the allocation volume and large allocations are always caught. A sample
+     * stands for the bytes allocated since the previous one: its weight is the larger of its
+     * size and the sampling interval. The stack of a sample is recorded as raw return addresses;
+     * the modules and the symbols are only resolved when a report is printed.
+     */
+    class HeapProfiler
+    {
+      public:
+        /**
+         * @brief Sampled allocation that was not freed yet.
+         */
+        struct Sample
+        {
+            /* Allocated block, nullptr for an empty slot, TOMBSTONE for a freed one. */
+            void* pointer;
+
+            /* Index of the call site. */
+            std::uint32_t site;
+
+            /* Sample weight in bytes. */
+            std::uint32_t weight;
+        };
+
+        /**
+         * @brief Starts sampling the allocations.
+         *
+         * @param interval Average number of the allocated bytes between two samples.
+         */
+        void enable(std::size_t interval);
+
+        /**
+         * @brief Returns true if the allocations are sampled.
+         */
+        [[nodiscard]] bool enabled() const noexcept;
+
+        /**
+         * @brief Counts an allocation towards the next sample of the calling thread.
+         */
+        void record_allocation(void* pointer, std::size_t size) noexcept;
+
+        /**
+         * @brief Removes a sampled allocation from the live bytes of its call site.
+         *
+         * @return The removed sample, its pointer is \c nullptr if the allocation was not sampled.
+         */
+        Sample record_free(void* pointer) noexcept;
+
+        /**
+         * @brief Puts back a sample removed by \c record_free() whose block was not freed after all.
+         */
+        void restore(const Sample& sample) noexcept;
+
+        /**
+         * @brief Clears the allocated bytes of the call sites and restarts the rate measurement.
+         */
+        void reset() noexcept;
+
+        /**
+         * @brief Prints the live bytes and the allocation rates per module, and the top call sites.
+         */
+        void print_report(std::size_t top_sites);
+
+        /**
+         * @brief Locks the profiler tables around \c fork, so the child does not inherit a held lock.
+         */
+        void lock_all() noexcept;
+
+        /**
+         * @brief Unlocks the profiler tables after \c fork.
+         */
+        void unlock_all() noexcept;
+
+      private:
+        /* Are the allocations sampled? */
+        std::atomic<bool> enabled_{};
+
+        /* Average number of the bytes between two samples. */
+        std::size_t interval_{};
+
+        /* Guards the call sites and the samples. */
+        std::mutex mutex_{};
+
+        /* Call sites. */
+        std::array<HeapProfileSite, HEAP_PROFILE_SITES> sites_{};
+
+        /* Number of the used call site slots. */
+        std::size_t site_count_{};
+
+        /* Sampled allocations, an open-addressing table keyed by the pointer. */
+        std::array<Sample, HEAP_PROFILE_SAMPLES> samples_{};
+
+        /* Number of the samples per slot group; lets free skip the lock for unsampled blocks. */
+        std::array<std::atomic<std::uint8_t>, HEAP_PROFILE_SAMPLES> filter_{};
+
+        /* Number of the samples taken. */
+        std::uint64_t sample_count_{};
+
+        /* Number of the samples that found the tables full. */
+        std::uint64_t dropped_{};
+
+        /* Start of the rate measurement. */
+        std::chrono::steady_clock::time_point reset_time_{};
+
+        /* Records a sampled allocation. */
+        void sample(void* pointer, std::size_t size) noexcept;
+
+        /* Stores a sample in the table and adds it to the live bytes of its call site; the lock must be held. */
+        void insert(const Sample& sample) noexcept;
+
+        /* Returns the index of the call site of a stack, adding it if needed; HEAP_PROFILE_SITES if full. */
+        [[nodiscard]] std::size_t find_site(void* const* frames, std::size_t depth) noexcept;
+
+        /* Returns a copy of the used call sites and the elapsed time since the reset, in seconds. */
+        [[nodiscard]] std::vector<HeapProfileSite> copy_sites(double& elapsed);
+    };
+
+    /**
+     * @brief Returns the process-wide heap profiler.
+     */
+    [[nodiscard]] HeapProfiler& get_heap_profiler() noexcept;
+
+    /**
+     * @brief Handler of the \c hlds_heapprofile console command.
+     */
+    void heap_profile_command(const std::string& args);
+
+    inline bool HeapProfiler::enabled() const noexcept
+    {
+        return enabled_.load(std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "histogram.h"
+#include <cassert>
+
+namespace rehlds::dedicated
+{
+    HistogramSummary Histogram::summary() const noexcept
+    {
+        std::array<std::uint64_t, BUCKET_COUNT> snapshot{};
+        std::uint64_t total = 0;
+
+        for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+            snapshot[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += snapshot[i];
+        }
+
+        HistogramSummary summary{};
+        summary.count = total;
+        summary.max = max_.load(std::memory_order_relaxed);
+
+        if (0 == total) {
+            return summary;
+        }
+
+        // Ranks of the percentiles, rounded up
+        const auto rank_p50 = (total * 500 + 999) / 1000;
+        const auto rank_p99 = (total * 990 + 999) / 1000;
+        const auto rank_p999 = (total * 999 + 999) / 1000;
+
+        std::uint64_t seen = 0;
+        std::uint64_t previous = 0;
+
+        for (std::size_t i = 0; (i < BUCKET_COUNT) && (seen < rank_p999); ++i) {
+            if (0 == snapshot[i]) {
+                continue;
+            }
+
+            previous = seen;
+            seen += snapshot[i];
+            const auto value = std::min(bucket_upper_bound(i), summary.max);
+
+            if ((previous < rank_p50) && (seen >= rank_p50)) {
+                summary.p50 = value;
+            }
+
+            if ((previous < rank_p99) && (seen >= rank_p99)) {
+                summary.p99 = value;
+            }
+
+            if (seen >= rank_p999) {
+                summary.p999 = value;
+            }
+        }
+
+        return summary;
+    }
+
+    void Histogram::reset() noexcept
+    {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+
+        count_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    std::uint64_t Histogram::bucket_upper_bound(const std::size_t index) noexcept
+    {
+        assert(index < BUCKET_COUNT);
+
+        if (index < SUB_BUCKET_COUNT) {
+            return index;
+        }
+
+        const auto shift = (index / SUB_BUCKET_COUNT) - 1;
+        const auto sub_bucket = index % SUB_BUCKET_COUNT;
+        const auto lower_bound = static_cast<std::uint64_t>(SUB_BUCKET_COUNT + sub_bucket) << shift;
+
+        return lower_bound + (std::uint64_t{1} << shift) - 1;
+    }
+}
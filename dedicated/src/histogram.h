@@ -0,0 +1,130 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Percentiles of the recorded values.
+     */
+    struct HistogramSummary
+    {
+        std::uint64_t count{};
+        std::uint64_t p50{};
+        std::uint64_t p99{};
+        std::uint64_t p999{};
+        std::uint64_t max{};
+    };
+
+    /**
+     * @brief Fixed-bucket log-linear (HDR-style) histogram of 32-bit values.
+     *
+     * Every power-of-two range is split into 32 linear sub-buckets, so a recorded value
+     * is reported with a relative error below 3.2%. Values larger than 32 bits are clamped.
+     *
+     * The histogram has a single writer: \c record() is a handful of plain loads and stores
+     * without locked instructions. Readers on other threads see a slightly stale but consistent
+     * enough view through relaxed atomics.
+     */
+    class Histogram
+    {
+      public:
+        /* Number of sub-buckets per power of two, as a power of two. */
+        static constexpr unsigned SUB_BUCKET_BITS = 5;
+        static constexpr std::uint32_t SUB_BUCKET_COUNT = 1U << SUB_BUCKET_BITS;
+        static constexpr std::size_t BUCKET_COUNT = (32 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+        /**
+         * @brief Records a value; negative values are recorded as zero.
+         */
+        void record(std::int64_t value) noexcept;
+
+        /**
+         * @brief Computes the percentiles of the recorded values.
+         */
+        [[nodiscard]] HistogramSummary summary() const noexcept;
+
+        /**
+         * @brief Returns the number of recorded values.
+         */
+        [[nodiscard]] std::uint64_t count() const noexcept;
+
+        /**
+         * @brief Clears the recorded values. Must be called by the writer thread.
+         */
+        void reset() noexcept;
+
+        /**
+         * @brief Returns the bucket index of the specified value.
+         */
+        [[nodiscard]] static std::size_t bucket_index(std::uint32_t value) noexcept;
+
+        /**
+         * @brief Returns the largest value that falls into the specified bucket.
+         */
+        [[nodiscard]] static std::uint64_t bucket_upper_bound(std::size_t index) noexcept;
+
+      private:
+        std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets_{};
+        std::atomic<std::uint64_t> count_{};
+        std::atomic<std::uint32_t> max_{};
+
+        /* Single-writer increment, compiles to a plain load/add/store. */
+        template <typename T>
+        static void increment(std::atomic<T>& counter) noexcept;
+    };
+
+    inline std::size_t Histogram::bucket_index(const std::uint32_t value) noexcept
+    {
+        if (value < SUB_BUCKET_COUNT) {
+            return value;
+        }
+
+#ifdef _MSC_VER
+        unsigned long msb{};
+        ::_BitScanReverse(&msb, value);
+#else
+        const auto msb = 31U - static_cast<unsigned>(__builtin_clz(value));
+#endif
+        const auto shift = msb - SUB_BUCKET_BITS;
+        const auto sub_bucket = (value >> shift) & (SUB_BUCKET_COUNT - 1);
+
+        return ((shift + 1) * SUB_BUCKET_COUNT) + sub_bucket;
+    }
+
+    template <typename T>
+    void Histogram::increment(std::atomic<T>& counter) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    inline void Histogram::record(const std::int64_t value) noexcept
+    {
+        constexpr std::int64_t max_value = UINT32_MAX;
+        const auto clamped = static_cast<std::uint32_t>(std::clamp(value, std::int64_t{0}, max_value));
+
+        increment(buckets_[bucket_index(clamped)]);
+        increment(count_);
+
+        if (clamped > max_.load(std::memory_order_relaxed)) {
+            max_.store(clamped, std::memory_order_relaxed);
+        }
+    }
+
+    inline std::uint64_t Histogram::count() const noexcept
+    {
+        return count_.load(std::memory_order_relaxed);
+    }
+}
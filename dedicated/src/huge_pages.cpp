@@ -0,0 +1,155 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "huge_pages.h"
+#include <link.h>
+#include <sys/mman.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    using rehlds::dedicated::HUGE_PAGE_SIZE;
+
+    /* Executable segment of a loaded object. */
+    struct TextSegment
+    {
+        /* Name of the searched module file. */
+        const char* file_name{};
+
+        /* First address of the segment. */
+        std::uintptr_t start{};
+
+        /* Address past the end of the segment. */
+        std::uintptr_t end{};
+    };
+
+    [[nodiscard]] std::uintptr_t align_up(const std::uintptr_t address) noexcept
+    {
+        return (address + HUGE_PAGE_SIZE - 1) & ~std::uintptr_t{HUGE_PAGE_SIZE - 1};
+    }
+
+    [[nodiscard]] std::uintptr_t align_down(const std::uintptr_t address) noexcept
+    {
+        return address & ~std::uintptr_t{HUGE_PAGE_SIZE - 1};
+    }
+
+    int find_text_segment(::dl_phdr_info* const info, [[maybe_unused]] const std::size_t size, void* const data)
+    {
+        auto& segment = *static_cast<TextSegment*>(data);
+        const auto* const name = (nullptr == info->dlpi_name) ? nullptr : std::strrchr(info->dlpi_name, '/');
+        const auto* const file_name = (nullptr == name) ? info->dlpi_name : name + 1;
+
+        if ((nullptr == file_name) || (0 != std::strcmp(file_name, segment.file_name))) {
+            return 0;
+        }
+
+        for (::ElfW(Half) i = 0; i < info->dlpi_phnum; ++i) {
+            if (const auto& header = info->dlpi_phdr[i]; (PT_LOAD == header.p_type) && (0 != (header.p_flags & PF_X))) {
+                segment.start = info->dlpi_addr + header.p_vaddr;
+                segment.end = segment.start + header.p_memsz;
+
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+
+    /* Returns the number of the huge pages backing the mapping that starts at the address. */
+    [[nodiscard]] std::size_t count_huge_pages(const std::uintptr_t address)
+    {
+        constexpr std::string_view field_name = "AnonHugePages:";
+
+        std::ifstream smaps{"/proc/self/smaps"};
+        std::string line{};
+        auto in_mapping = false;
+
+        while (std::getline(smaps, line)) {
+            // Fields are "Name: value", mapping headers are "start-end perms offset dev:minor inode path"
+            if (line.find(':') < line.find(' ')) {
+                if (in_mapping && (0 == line.rfind(field_name, 0))) {
+                    const auto kilobytes = std::strtoull(line.c_str() + field_name.size(), nullptr, 10);
+                    return static_cast<std::size_t>(kilobytes * 1024 / HUGE_PAGE_SIZE);
+                }
+
+                continue;
+            }
+
+            char* end = nullptr;
+            in_mapping = (std::strtoull(line.c_str(), &end, 16) == address) && ('-' == *end);
+        }
+
+        return 0;
+    }
+}
+
+namespace rehlds::dedicated
+{
+    bool huge_pages_available()
+    {
+        std::ifstream file{"/sys/kernel/mm/transparent_hugepage/enabled"};
+        std::string mode{};
+
+        return std::getline(file, mode) && (std::string::npos == mode.find("[never]"));
+    }
+
+    bool remap_text_to_huge_pages(const std::string& module_file, HugePageText& result)
+    {
+        TextSegment segment{module_file.c_str()};
+
+        if (0 == ::dl_iterate_phdr(&find_text_segment, &segment)) {
+            errno = ENOENT;
+            return false;
+        }
+
+        result.text_size = segment.end - segment.start;
+        const auto start = align_up(segment.start);
+        const auto end = align_down(segment.end);
+
+        if (end <= start) {
+            return true;
+        }
+
+        // Reserve one huge page more than needed to align the copy
+        const auto size = end - start;
+        auto* const reserved = ::mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+        if (MAP_FAILED == reserved) {
+            return false;
+        }
+
+        const auto reserved_start = reinterpret_cast<std::uintptr_t>(reserved);
+        const auto copy_start = align_up(reserved_start);
+        auto* const copy = reinterpret_cast<void*>(copy_start);
+
+        if (copy_start > reserved_start) {
+            ::munmap(reserved, copy_start - reserved_start);
+        }
+
+        if (const auto slack = reserved_start + HUGE_PAGE_SIZE - copy_start; slack > 0) {
+            ::munmap(reinterpret_cast<void*>(copy_start + size), slack);
+        }
+
+        ::madvise(copy, size, MADV_HUGEPAGE);
+        std::memcpy(copy, reinterpret_cast<const void*>(start), size);
+
+        if ((0 != ::mprotect(copy, size, PROT_READ | PROT_EXEC)) ||
+            (MAP_FAILED == ::mremap(copy, size, size, MREMAP_MAYMOVE | MREMAP_FIXED, reinterpret_cast<void*>(start)))) {
+            ::munmap(copy, size);
+            return false;
+        }
+
+        result.remapped_size = size;
+        result.huge_pages = count_huge_pages(start);
+
+        return true;
+    }
+}
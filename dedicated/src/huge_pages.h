@@ -0,0 +1,52 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Size of a transparent huge page.
+     */
+    constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /**
+     * @brief Outcome of remapping the text of a module.
+     */
+    struct HugePageText
+    {
+        /* Size of the executable segment. */
+        std::size_t text_size{};
+
+        /* Size of the huge page aligned part of the segment that was remapped. */
+        std::size_t remapped_size{};
+
+        /* Number of the huge pages backing the remapped part. */
+        std::size_t huge_pages{};
+    };
+
+    /**
+     * @brief Returns true if transparent huge pages are enabled for \c madvise or always.
+     */
+    [[nodiscard]] bool huge_pages_available();
+
+    /**
+     * @brief Moves the executable segment of a loaded module onto transparent huge pages, at the same addresses.
+     *
+     * The huge page aligned part of the segment is copied into an anonymous mapping advised with
+     * \c MADV_HUGEPAGE, which then replaces the file mapping with \c mremap, so the module text is
+     * never unmapped. No other thread may execute the module code meanwhile. The remapped text is
+     * anonymous memory: it is no longer shared with other processes, and profilers reading
+     * <tt>/proc/pid/maps</tt> cannot attribute it to the module file.
+     *
+     * @param module_file Module file name, matched against the file names of the loaded objects.
+     * @param result Receives the sizes and the number of the huge pages.
+     *
+     * @return \c true if the module text was remapped or is too small to remap, otherwise \c false and \c errno is set
+     */
+    bool remap_text_to_huge_pages(const std::string& module_file, HugePageText& result);
+}
@@ -0,0 +1,258 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "idle_governor.h"
+#include "clock.h"
+#include "console/text_console.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <system_error>
+#include <unistd.h>
+
+namespace
+{
+    /* Interval of the player count checks. */
+    constexpr std::int64_t CHECK_INTERVAL = 500 * rehlds::dedicated::NANOSECONDS_PER_MILLISECOND;
+
+    /* Time the server must be empty before it goes idle. */
+    constexpr std::int64_t IDLE_DELAY = 5 * rehlds::dedicated::NANOSECONDS_PER_SECOND;
+
+    /* Maximum number of events returned by a single wait. */
+    constexpr auto MAX_EVENTS = 8;
+
+    /* Returns the CPU time consumed by the calling thread, in nanoseconds. */
+    [[nodiscard]] std::int64_t thread_cpu_time() noexcept
+    {
+        ::timespec time{};
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+
+        return (static_cast<std::int64_t>(time.tv_sec) * rehlds::dedicated::NANOSECONDS_PER_SECOND) + time.tv_nsec;
+    }
+
+    /* Returns true if the descriptor is an IPv4 or IPv6 datagram socket bound to the port. */
+    [[nodiscard]] bool is_server_socket(const int descriptor, const std::uint16_t port) noexcept
+    {
+        struct stat status{};
+
+        if ((0 != ::fstat(descriptor, &status)) || (!S_ISSOCK(status.st_mode))) {
+            return false;
+        }
+
+        auto type = 0;
+        auto length = static_cast<::socklen_t>(sizeof(type));
+
+        if ((0 != ::getsockopt(descriptor, SOL_SOCKET, SO_TYPE, &type, &length)) || (SOCK_DGRAM != type)) {
+            return false;
+        }
+
+        ::sockaddr_storage address{};
+        length = static_cast<::socklen_t>(sizeof(address));
+
+        if (0 != ::getsockname(descriptor, reinterpret_cast<::sockaddr*>(&address), &length)) {
+            return false;
+        }
+
+        std::uint16_t bound_port = 0;
+
+        if (AF_INET == address.ss_family) {
+            bound_port = reinterpret_cast<const ::sockaddr_in*>(&address)->sin_port;
+        }
+        else if (AF_INET6 == address.ss_family) {
+            bound_port = reinterpret_cast<const ::sockaddr_in6*>(&address)->sin6_port;
+        }
+        else {
+            return false;
+        }
+
+        return ::htons(port) == bound_port;
+    }
+}
+
+namespace rehlds::dedicated
+{
+    bool IdleGovernor::start(const std::int64_t sleep_time, const std::uint16_t port)
+    {
+        stop();
+
+        if (sleep_time <= 0) {
+            return false;
+        }
+
+        const auto now = clock_now();
+        sleep_time_ = sleep_time;
+        port_ = port;
+        next_check_ = now;
+        last_occupied_ = now;
+        last_time_ = now;
+        last_cpu_time_ = thread_cpu_time();
+        stats_ = {};
+
+        return true;
+    }
+
+    void IdleGovernor::stop() noexcept
+    {
+        if (enabled()) {
+            account(clock_now());
+        }
+
+        if (epoll_fd_ >= 0) {
+            ::close(epoll_fd_);
+            epoll_fd_ = -1;
+        }
+
+        sleep_time_ = 0;
+        idle_ = false;
+    }
+
+    std::int64_t IdleGovernor::sleep(const std::int64_t now)
+    {
+        const auto deadline = now + sleep_time_;
+        const auto timeout = static_cast<int>(sleep_time_ / NANOSECONDS_PER_MILLISECOND);
+        std::array<::epoll_event, MAX_EVENTS> events{};
+
+        ++stats_.idle_sleeps;
+
+        if (::epoll_wait(epoll_fd_, events.data(), MAX_EVENTS, timeout) > 0) {
+            // Back to the full frame rate until the next check finds the server still empty
+            const auto wake_time = clock_now();
+            ++stats_.packet_wakeups;
+            account(wake_time);
+            idle_ = false;
+            next_check_ = wake_time + CHECK_INTERVAL;
+
+            return wake_time;
+        }
+
+        return deadline;
+    }
+
+    std::int64_t IdleGovernor::saved_cpu_time() const noexcept
+    {
+        if (stats_.active_time <= 0) {
+            return 0;
+        }
+
+        const auto usage = static_cast<double>(stats_.active_cpu_time) / static_cast<double>(stats_.active_time);
+        const auto saved = (static_cast<double>(stats_.idle_time) * usage) - static_cast<double>(stats_.idle_cpu_time);
+
+        return std::max(static_cast<std::int64_t>(saved), std::int64_t{0});
+    }
+
+    void IdleGovernor::print_status() const
+    {
+        const auto usage = [](const std::int64_t cpu_time, const std::int64_t time)
+        {
+            return time > 0 ? static_cast<double>(cpu_time) * 100.0 / static_cast<double>(time) : 0.0;
+        };
+
+        if (!enabled()) {
+            TextConsole::print("Idle governor: stopped.\n");
+        }
+        else if (idle_) {
+            TextConsole::print("Idle governor: idle, waiting on {} sockets for at most {:.0f} ms.\n", sockets_,
+              to_milliseconds(sleep_time_));
+        }
+        else {
+            TextConsole::print("Idle governor: running at the full rate.\n");
+        }
+
+        TextConsole::print("Idle governor: {} idle periods, {} idle sleeps, {} ended by network input.\n",
+          stats_.idle_periods, stats_.idle_sleeps, stats_.packet_wakeups);
+
+        TextConsole::print("Idle governor: {:.1f} s idle at {:.2f}% CPU, {:.1f} s at the full rate at {:.2f}% CPU, "
+                           "about {:.1f} s of CPU time saved.\n",
+          to_milliseconds(stats_.idle_time) / 1000.0, usage(stats_.idle_cpu_time, stats_.idle_time),
+          to_milliseconds(stats_.active_time) / 1000.0, usage(stats_.active_cpu_time, stats_.active_time),
+          to_milliseconds(saved_cpu_time()) / 1000.0);
+    }
+
+    void IdleGovernor::check(const std::int64_t now)
+    {
+        // The console reads the status from the engine at the same interval
+        const auto active_players = TextConsole::instance().active_players();
+
+        account(now);
+        next_check_ = now + CHECK_INTERVAL;
+
+        // The player count is unknown until the first status update
+        if (0 != active_players) {
+            last_occupied_ = now;
+            idle_ = false;
+        }
+        else if ((!idle_) && (now - last_occupied_ >= IDLE_DELAY)) {
+            // The engine opens its sockets on map load, so the set is refreshed each time
+            idle_ = watch_sockets();
+            stats_.idle_periods += idle_ ? 1 : 0;
+        }
+    }
+
+    void IdleGovernor::account(const std::int64_t now)
+    {
+        const auto cpu_time = thread_cpu_time();
+
+        if (idle_) {
+            stats_.idle_time += now - last_time_;
+            stats_.idle_cpu_time += cpu_time - last_cpu_time_;
+        }
+        else {
+            stats_.active_time += now - last_time_;
+            stats_.active_cpu_time += cpu_time - last_cpu_time_;
+        }
+
+        last_time_ = now;
+        last_cpu_time_ = cpu_time;
+    }
+
+    bool IdleGovernor::watch_sockets()
+    {
+        if (epoll_fd_ >= 0) {
+            ::close(epoll_fd_);
+        }
+
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        sockets_ = 0;
+
+        if (epoll_fd_ < 0) {
+            return false;
+        }
+
+        std::error_code error{};
+        std::filesystem::directory_iterator entry{"/proc/self/fd", error};
+
+        // The increment reports errors through the error code instead of throwing
+        for (; (!error) && (entry != std::filesystem::directory_iterator{}); entry.increment(error)) {
+            const auto descriptor = std::atoi(entry->path().filename().c_str());
+
+            // Only input for the server ends the sleep, not that of the other sockets of the process
+            if ((descriptor == epoll_fd_) || (!is_server_socket(descriptor, port_))) {
+                continue;
+            }
+
+            ::epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = descriptor;
+
+            if (0 == ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, descriptor, &event)) {
+                ++sockets_;
+            }
+        }
+
+        // Without sockets a connecting player would wait for the timeout, so the server stays at the full rate
+        return sockets_ > 0;
+    }
+
+    void idle_command(const std::string& /* args */)
+    {
+        get_idle_governor().print_status();
+    }
+}
@@ -0,0 +1,199 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "cpputils/singleton_holder.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Idle governor statistics.
+     */
+    struct IdleGovernorStats
+    {
+        /* Number of times the server went idle. */
+        std::uint64_t idle_periods{};
+
+        /* Number of the idle sleeps. */
+        std::uint64_t idle_sleeps{};
+
+        /* Number of the idle sleeps ended by network input. */
+        std::uint64_t packet_wakeups{};
+
+        /* Time spent idle, in nanoseconds. */
+        std::int64_t idle_time{};
+
+        /* Time spent at the full frame rate, in nanoseconds. */
+        std::int64_t active_time{};
+
+        /* Server thread CPU time consumed while idle, in nanoseconds. */
+        std::int64_t idle_cpu_time{};
+
+        /* Server thread CPU time consumed at the full frame rate, in nanoseconds. */
+        std::int64_t active_cpu_time{};
+    };
+
+    /**
+     * @brief Slows the server loop down while the server is empty.
+     *
+     * The player count is taken from the console status, which the engine updates twice a second.
+     * Once the server has been empty for a few seconds, the sleep of the \c -pingboost mode is
+     * replaced by an \c epoll_wait() with a long timeout on the UDP sockets bound to the server
+     * port, which serve both the clients and the queries, so the engine runs a few frames per second.
+     * The first packet ends the idle sleep and the server runs at the full frame rate again until
+     * the next player count check. The server thread CPU time is accounted separately for both
+     * states, which gives an estimate of the CPU time the idle sleeps saved.
+     */
+    class IdleGovernor
+    {
+      public:
+        IdleGovernor() = default;
+        IdleGovernor(IdleGovernor&&) = delete;
+        IdleGovernor(const IdleGovernor&) = delete;
+        IdleGovernor& operator=(IdleGovernor&&) = delete;
+        IdleGovernor& operator=(const IdleGovernor&) = delete;
+        ~IdleGovernor();
+
+        /**
+         * @brief Starts governing the calling thread.
+         *
+         * @param sleep_time Longest idle sleep, in nanoseconds.
+         * @param port UDP port of the server, whose sockets end the idle sleeps.
+         *
+         * @return \c true if the governor was started, otherwise \c false
+         */
+        bool start(std::int64_t sleep_time, std::uint16_t port);
+
+        /**
+         * @brief Stops the governor; the statistics are kept until the next start.
+         */
+        void stop() noexcept;
+
+        /**
+         * @brief Returns true if the governor is running.
+         */
+        [[nodiscard]] bool enabled() const noexcept;
+
+        /**
+         * @brief Returns true if the server is idle.
+         */
+        [[nodiscard]] bool idle() const noexcept;
+
+        /**
+         * @brief Checks the player count when the check interval has elapsed.
+         *
+         * @param now Current time of the monotonic clock, in nanoseconds.
+         */
+        void update(std::int64_t now);
+
+        /**
+         * @brief Sleeps until network input arrives or the idle sleep time elapses.
+         *
+         * @param now Current time of the monotonic clock, in nanoseconds.
+         *
+         * @return Wake-up time the sleep was asked for, on the monotonic clock.
+         */
+        std::int64_t sleep(std::int64_t now);
+
+        /**
+         * @brief Returns the statistics accounted up to the last player count check.
+         */
+        [[nodiscard]] const IdleGovernorStats& stats() const noexcept;
+
+        /**
+         * @brief Returns the estimated server thread CPU time the idle sleeps saved, in nanoseconds.
+         *
+         * The estimate is the CPU time the idle time would have consumed at the full frame rate,
+         * minus the CPU time it actually consumed.
+         */
+        [[nodiscard]] std::int64_t saved_cpu_time() const noexcept;
+
+        /**
+         * @brief Prints the state and the statistics to the console.
+         */
+        void print_status() const;
+
+      private:
+        /* Epoll instance descriptor with the server sockets. */
+        int epoll_fd_{-1};
+
+        /* UDP port of the server. */
+        std::uint16_t port_{};
+
+        /* Number of the sockets registered in the epoll instance. */
+        std::size_t sockets_{};
+
+        /* Longest idle sleep, in nanoseconds. */
+        std::int64_t sleep_time_{};
+
+        /* Is the server idle? */
+        bool idle_{};
+
+        /* Time of the next player count check. */
+        std::int64_t next_check_{};
+
+        /* Last time the server had players. */
+        std::int64_t last_occupied_{};
+
+        /* Times of the last accounting on the monotonic and on the thread CPU clock. */
+        std::int64_t last_time_{};
+        std::int64_t last_cpu_time_{};
+
+        /* Accounted statistics. */
+        IdleGovernorStats stats_{};
+
+        /* Checks the player count and switches the state. */
+        void check(std::int64_t now);
+
+        /* Adds the time since the last accounting to the current state. */
+        void account(std::int64_t now);
+
+        /* Registers the UDP sockets bound to the server port in a new epoll instance. */
+        bool watch_sockets();
+    };
+
+    inline IdleGovernor::~IdleGovernor()
+    {
+        stop();
+    }
+
+    inline bool IdleGovernor::enabled() const noexcept
+    {
+        return sleep_time_ > 0;
+    }
+
+    inline bool IdleGovernor::idle() const noexcept
+    {
+        return idle_;
+    }
+
+    inline void IdleGovernor::update(const std::int64_t now)
+    {
+        if (now >= next_check_) {
+            check(now);
+        }
+    }
+
+    inline const IdleGovernorStats& IdleGovernor::stats() const noexcept
+    {
+        return stats_;
+    }
+
+    /**
+     * @brief Returns an idle governor instance.
+     */
+    [[nodiscard]] inline IdleGovernor& get_idle_governor()
+    {
+        return cpputils::SingletonHolder<IdleGovernor>::get_instance();
+    }
+
+    /**
+     * @brief Handler of the \c hlds_idle console command.
+     */
+    void idle_command(const std::string& args);
+}
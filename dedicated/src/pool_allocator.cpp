@@ -0,0 +1,514 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "pool_allocator.h"
+#include "console/text_console.h"
+#include "cpputils/string.h"
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <immintrin.h>
+#include <mutex>
+#include <new>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace
+{
+    using rehlds::dedicated::PoolAllocator;
+
+    constexpr double MEGABYTE = 1024.0 * 1024.0;
+
+    /* Process-wide pool; constant-initialized, so it is usable before the static constructors run. */
+    PoolAllocator pool_allocator{};
+
+    /* States of a pool lock. */
+    constexpr std::uint32_t LOCK_FREE = 0;
+    constexpr std::uint32_t LOCK_HELD = 1;
+    constexpr std::uint32_t LOCK_CONTENDED = 2;
+
+    /* Number of the lock attempts before a thread waits on the futex. */
+    constexpr auto LOCK_SPIN_COUNT = 100;
+
+    /* Key whose destructor releases the thread cache at thread exit. */
+    ::pthread_key_t thread_cache_key{};
+
+    /* Number of the blocks moved between a thread cache and the central lists at once. */
+    [[nodiscard]] constexpr std::uint32_t batch_size(const std::size_t size_class) noexcept
+    {
+        const auto blocks = rehlds::dedicated::POOL_SPAN_SIZE / rehlds::dedicated::pool_block_size(size_class);
+        return static_cast<std::uint32_t>(std::clamp<std::size_t>(blocks / 8, 1, 64));
+    }
+
+    void lock_before_fork() noexcept
+    {
+        pool_allocator.lock_all();
+    }
+
+    void unlock_after_fork() noexcept
+    {
+        pool_allocator.unlock_all();
+    }
+}
+
+namespace rehlds::dedicated
+{
+    /* Free blocks the calling thread keeps per size class. */
+    struct PoolAllocator::ThreadCache
+    {
+        /* Free blocks. */
+        std::array<Block*, POOL_SIZE_CLASSES> lists;
+
+        /* Number of the free blocks. */
+        std::array<std::uint32_t, POOL_SIZE_CLASSES> counts;
+
+        /* Is the cache released at thread exit? */
+        bool registered;
+    };
+
+    thread_local PoolAllocator::ThreadCache PoolAllocator::thread_cache_{};
+
+    void PoolLock::lock() noexcept
+    {
+        for (auto spin = 0; spin < LOCK_SPIN_COUNT; ++spin) {
+            auto state = LOCK_FREE;
+
+            if (state_.compare_exchange_weak(state, LOCK_HELD, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+
+            _mm_pause();
+        }
+
+        // The holder wakes a waiter when it finds the lock contended on release
+        while (LOCK_FREE != state_.exchange(LOCK_CONTENDED, std::memory_order_acquire)) {
+            ::syscall(SYS_futex, &state_, FUTEX_WAIT_PRIVATE, LOCK_CONTENDED, nullptr, nullptr, 0);
+        }
+    }
+
+    void PoolLock::unlock() noexcept
+    {
+        if (LOCK_CONTENDED == state_.exchange(LOCK_FREE, std::memory_order_release)) {
+            ::syscall(SYS_futex, &state_, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+        }
+    }
+
+    bool PoolAllocator::enable(const std::size_t size)
+    {
+        if (enabled()) {
+            return true;
+        }
+
+        const auto span_count = size / POOL_SPAN_SIZE;
+        const auto pool_size = span_count * POOL_SPAN_SIZE;
+        const auto bookkeeping_size = span_count * sizeof(Span);
+
+        if (0 == span_count) {
+            return false;
+        }
+
+        // Neither the pool nor its bookkeeping may come from malloc
+        auto* const bookkeeping =
+          ::mmap(nullptr, bookkeeping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (MAP_FAILED == bookkeeping) {
+            return false;
+        }
+
+        auto* const memory =
+          ::mmap(nullptr, pool_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+        if ((MAP_FAILED == memory) || (0 != ::pthread_key_create(&thread_cache_key, &thread_exit))) {
+            ::munmap(bookkeeping, bookkeeping_size);
+
+            if (MAP_FAILED != memory) {
+                ::munmap(memory, pool_size);
+            }
+
+            return false;
+        }
+
+        ::pthread_atfork(&lock_before_fork, &unlock_after_fork, &unlock_after_fork);
+        spans_ = static_cast<Span*>(bookkeeping);
+
+        for (std::size_t i = 0; i < span_count; ++i) {
+            new (&spans_[i]) Span{nullptr, nullptr, nullptr, 0, 0, POOL_SIZE_CLASSES, false, false};
+        }
+
+        const auto begin = reinterpret_cast<std::uintptr_t>(memory);
+        span_count_ = span_count;
+        begin_.store(begin, std::memory_order_relaxed);
+        end_.store(begin + pool_size, std::memory_order_relaxed);
+        enabled_.store(true, std::memory_order_release);
+
+        return true;
+    }
+
+    void* PoolAllocator::allocate(const std::size_t size) noexcept
+    {
+        if (size > POOL_MAX_BLOCK_SIZE) {
+            oversized_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        const auto size_class = pool_size_class(size);
+        auto& cache = thread_cache_;
+        auto*& list = cache.lists[size_class];
+
+        if (nullptr == list) {
+            register_thread_cache();
+            const auto taken = take_blocks(size_class, batch_size(size_class), list);
+            cache.counts[size_class] = static_cast<std::uint32_t>(taken);
+
+            if (nullptr == list) {
+                exhausted_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+
+        auto* const block = list;
+        list = block->next;
+        --cache.counts[size_class];
+
+        return block;
+    }
+
+    void PoolAllocator::deallocate(void* const pointer) noexcept
+    {
+        // The class of a span does not change while any of its blocks is allocated
+        const auto size_class = span_of(pointer).size_class;
+        const auto batch = batch_size(size_class);
+        auto& cache = thread_cache_;
+        auto*& list = cache.lists[size_class];
+
+        auto* const block = static_cast<Block*>(pointer);
+        block->next = list;
+        list = block;
+
+        if (++cache.counts[size_class] <= 2 * batch) {
+            return;
+        }
+
+        register_thread_cache();
+
+        // Keep the most recently freed blocks, which are likely still in the CPU cache
+        auto* last = list;
+
+        for (std::uint32_t i = 1; i < batch; ++i) {
+            last = last->next;
+        }
+
+        auto* const released = last->next;
+        last->next = nullptr;
+        cache.counts[size_class] = batch;
+        return_blocks(size_class, released);
+    }
+
+    std::size_t PoolAllocator::block_size(const void* const pointer) const noexcept
+    {
+        return pool_block_size(span_of(pointer).size_class);
+    }
+
+    void PoolAllocator::flush_thread_cache() noexcept
+    {
+        auto& cache = thread_cache_;
+
+        for (std::size_t size_class = 0; size_class < POOL_SIZE_CLASSES; ++size_class) {
+            if (nullptr != cache.lists[size_class]) {
+                return_blocks(size_class, cache.lists[size_class]);
+                cache.lists[size_class] = nullptr;
+                cache.counts[size_class] = 0;
+            }
+        }
+    }
+
+    std::size_t PoolAllocator::trim() noexcept
+    {
+        if (!enabled()) {
+            return 0;
+        }
+
+        flush_thread_cache();
+
+        std::size_t released = 0;
+        const std::lock_guard lock{span_lock_};
+
+        for (auto* span = free_spans_; nullptr != span; span = span->next) {
+            if (!span->released) {
+                ::madvise(reinterpret_cast<void*>(span_address(*span)), POOL_SPAN_SIZE, MADV_DONTNEED);
+                span->released = true;
+                ++released_spans_;
+                released += POOL_SPAN_SIZE;
+            }
+        }
+
+        released_bytes_ += released;
+        ++trims_;
+
+        return released;
+    }
+
+    PoolStats PoolAllocator::stats() noexcept
+    {
+        PoolStats stats{};
+
+        for (std::size_t size_class = 0; size_class < POOL_SIZE_CLASSES; ++size_class) {
+            auto& central = classes_[size_class];
+            const std::lock_guard lock{central.lock};
+            stats.classes[size_class] = {pool_block_size(size_class), central.spans, central.used_blocks};
+        }
+
+        const std::lock_guard lock{span_lock_};
+        stats.reserved_bytes = span_count_ * POOL_SPAN_SIZE;
+        stats.committed_bytes = (spans_taken_ - released_spans_) * POOL_SPAN_SIZE;
+        stats.free_spans = free_span_count_;
+        stats.released_bytes = released_bytes_;
+        stats.trims = trims_;
+        stats.oversized_allocations = oversized_.load(std::memory_order_relaxed);
+        stats.exhausted_allocations = exhausted_.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
+    void PoolAllocator::lock_all() noexcept
+    {
+        for (auto& central : classes_) {
+            central.lock.lock();
+        }
+
+        span_lock_.lock();
+    }
+
+    void PoolAllocator::unlock_all() noexcept
+    {
+        span_lock_.unlock();
+
+        for (auto& central : classes_) {
+            central.lock.unlock();
+        }
+    }
+
+    PoolAllocator::Span& PoolAllocator::span_of(const void* const pointer) const noexcept
+    {
+        const auto offset = reinterpret_cast<std::uintptr_t>(pointer) - begin_.load(std::memory_order_relaxed);
+        return spans_[offset / POOL_SPAN_SIZE];
+    }
+
+    std::uintptr_t PoolAllocator::span_address(const Span& span) const noexcept
+    {
+        const auto index = static_cast<std::uintptr_t>(&span - spans_);
+        return begin_.load(std::memory_order_relaxed) + (index * POOL_SPAN_SIZE);
+    }
+
+    std::size_t PoolAllocator::take_blocks(const std::size_t size_class, const std::size_t count, Block*& list) noexcept
+    {
+        auto& central = classes_[size_class];
+        const auto size = pool_block_size(size_class);
+        const auto capacity = static_cast<std::uint32_t>(POOL_SPAN_SIZE / size);
+        std::size_t taken = 0;
+
+        const std::lock_guard lock{central.lock};
+
+        while (taken < count) {
+            auto* span = central.partial;
+
+            if (nullptr == span) {
+                span = take_span(size_class);
+
+                if (nullptr == span) {
+                    break;
+                }
+
+                ++central.spans;
+                push_span(central.partial, *span);
+                span->partial = true;
+            }
+
+            while (taken < count) {
+                Block* block = span->free_list;
+
+                if (nullptr != block) {
+                    span->free_list = block->next;
+                }
+                else if (span->carved < capacity) {
+                    // Blocks are carved on demand, so a fresh span touches only the pages it hands out
+                    block = reinterpret_cast<Block*>(span_address(*span) + (span->carved * size));
+                    ++span->carved;
+                }
+                else {
+                    break;
+                }
+
+                ++span->used;
+                block->next = list;
+                list = block;
+                ++taken;
+            }
+
+            if ((nullptr == span->free_list) && (capacity == span->carved)) {
+                remove_span(central.partial, *span);
+                span->partial = false;
+            }
+        }
+
+        central.used_blocks += taken;
+
+        return taken;
+    }
+
+    void PoolAllocator::return_blocks(const std::size_t size_class, Block* list) noexcept
+    {
+        auto& central = classes_[size_class];
+        const std::lock_guard lock{central.lock};
+
+        while (nullptr != list) {
+            auto* const block = list;
+            list = list->next;
+
+            auto& span = span_of(block);
+            block->next = span.free_list;
+            span.free_list = block;
+            --span.used;
+            --central.used_blocks;
+
+            if (0 == span.used) {
+                if (span.partial) {
+                    remove_span(central.partial, span);
+                }
+
+                --central.spans;
+                release_span(span);
+            }
+            else if (!span.partial) {
+                push_span(central.partial, span);
+                span.partial = true;
+            }
+        }
+    }
+
+    PoolAllocator::Span* PoolAllocator::take_span(const std::size_t size_class) noexcept
+    {
+        const std::lock_guard lock{span_lock_};
+        auto* span = free_spans_;
+
+        if (nullptr != span) {
+            remove_span(free_spans_, *span);
+            --free_span_count_;
+
+            // The released pages fault back in as zero pages
+            if (span->released) {
+                span->released = false;
+                --released_spans_;
+            }
+        }
+        else if (spans_taken_ < span_count_) {
+            span = &spans_[spans_taken_++];
+        }
+        else {
+            return nullptr;
+        }
+
+        span->free_list = nullptr;
+        span->used = 0;
+        span->carved = 0;
+        span->size_class = static_cast<std::uint32_t>(size_class);
+        span->partial = false;
+
+        return span;
+    }
+
+    void PoolAllocator::release_span(Span& span) noexcept
+    {
+        span.free_list = nullptr;
+        span.carved = 0;
+        span.size_class = POOL_SIZE_CLASSES;
+        span.partial = false;
+
+        const std::lock_guard lock{span_lock_};
+        push_span(free_spans_, span);
+        ++free_span_count_;
+    }
+
+    void PoolAllocator::push_span(Span*& head, Span& span) noexcept
+    {
+        span.prev = nullptr;
+        span.next = head;
+
+        if (nullptr != head) {
+            head->prev = &span;
+        }
+
+        head = &span;
+    }
+
+    void PoolAllocator::remove_span(Span*& head, Span& span) noexcept
+    {
+        if (nullptr != span.prev) {
+            span.prev->next = span.next;
+        }
+        else {
+            head = span.next;
+        }
+
+        if (nullptr != span.next) {
+            span.next->prev = span.prev;
+        }
+
+        span.prev = nullptr;
+        span.next = nullptr;
+    }
+
+    void PoolAllocator::register_thread_cache() noexcept
+    {
+        if (auto& cache = thread_cache_; !cache.registered) {
+            cache.registered = true;
+            ::pthread_setspecific(thread_cache_key, &cache);
+        }
+    }
+
+    void PoolAllocator::thread_exit([[maybe_unused]] void* const cache) noexcept
+    {
+        pool_allocator.flush_thread_cache();
+
+        // Allocations made by the later thread-exit destructors register the cache again
+        thread_cache_.registered = false;
+    }
+
+    PoolAllocator& get_pool_allocator() noexcept
+    {
+        return pool_allocator;
+    }
+
+    void pool_stats_command(const std::string& args)
+    {
+        auto& pool = get_pool_allocator();
+
+        if (!pool.enabled()) {
+            TextConsole::print("Pool allocator is disabled, see -poolalloc.\n");
+            return;
+        }
+
+        if (cpputils::equal_ignore_case(args, "trim")) {
+            const auto released = pool.trim();
+            TextConsole::print("Pool allocator: released {:.1f} MB.\n", static_cast<double>(released) / MEGABYTE);
+            return;
+        }
+
+        const auto stats = pool.stats();
+
+        TextConsole::print("Pool allocator: {:.1f} MB reserved, {:.1f} MB committed, {} free spans, "
+                           "{:.1f} MB released by {} trims, {} oversized and {} exhausted allocations.\n",
+          static_cast<double>(stats.reserved_bytes) / MEGABYTE, static_cast<double>(stats.committed_bytes) / MEGABYTE,
+          stats.free_spans, static_cast<double>(stats.released_bytes) / MEGABYTE, stats.trims,
+          stats.oversized_allocations, stats.exhausted_allocations);
+
+        for (const auto& size_class : stats.classes) {
+            if (0 != size_class.spans) {
+                TextConsole::print("  {:>5} B: {} spans, {} blocks in use.\n", size_class.block_size, size_class.spans,
+                  size_class.used_blocks);
+            }
+        }
+    }
+}
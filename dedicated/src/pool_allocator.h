@@ -0,0 +1,391 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Size of a span, the unit of memory a size class takes from the pool.
+     */
+    constexpr std::size_t POOL_SPAN_SIZE = 64 * 1024;
+
+    /**
+     * @brief Largest block served by the pool; larger allocations are left to the C library.
+     */
+    constexpr std::size_t POOL_MAX_BLOCK_SIZE = 16 * 1024;
+
+    /**
+     * @brief Alignment of the pool blocks.
+     */
+    constexpr std::size_t POOL_ALIGNMENT = 16;
+
+    /**
+     * @brief Number of the size classes: 16 byte steps up to 256 bytes, then four classes per power of two.
+     */
+    constexpr std::size_t POOL_SIZE_CLASSES = 40;
+
+    /**
+     * @brief Returns the block size of a size class.
+     */
+    [[nodiscard]] constexpr std::size_t pool_block_size(const std::size_t size_class) noexcept
+    {
+        constexpr std::size_t small_classes = 16;
+
+        if (size_class < small_classes) {
+            return (size_class + 1) * POOL_ALIGNMENT;
+        }
+
+        const auto group = (size_class - small_classes) / 4;
+        const auto step = std::size_t{64} << group;
+
+        return (std::size_t{256} << group) + ((((size_class - small_classes) % 4) + 1) * step);
+    }
+
+    /**
+     * @brief Returns the smallest size class holding the size, which must not exceed \c POOL_MAX_BLOCK_SIZE.
+     */
+    [[nodiscard]] constexpr std::size_t pool_size_class(const std::size_t size) noexcept
+    {
+        if (size <= 256) {
+            return 0 == size ? 0 : ((size + POOL_ALIGNMENT - 1) / POOL_ALIGNMENT) - 1;
+        }
+
+        std::size_t group = 0;
+
+        while ((std::size_t{512} << group) < size) {
+            ++group;
+        }
+
+        const auto base = std::size_t{256} << group;
+        const auto step = std::size_t{64} << group;
+
+        return 16 + (group * 4) + ((size - base + step - 1) / step) - 1;
+    }
+
+    /**
+     * @brief Usage of a size class.
+     */
+    struct PoolClassStats
+    {
+        /* Block size. */
+        std::size_t block_size{};
+
+        /* Spans owned by the class. */
+        std::size_t spans{};
+
+        /* Blocks handed out to the threads, including the blocks held by the thread caches. */
+        std::size_t used_blocks{};
+    };
+
+    /**
+     * @brief Usage of the pool.
+     */
+    struct PoolStats
+    {
+        /* Reserved address space. */
+        std::size_t reserved_bytes{};
+
+        /* Spans backed by memory, including the free spans not yet released. */
+        std::size_t committed_bytes{};
+
+        /* Spans owned by no size class. */
+        std::size_t free_spans{};
+
+        /* Memory returned to the system by the trims so far. */
+        std::uint64_t released_bytes{};
+
+        /* Number of the trims. */
+        std::uint64_t trims{};
+
+        /* Allocations left to the C library because they exceed the largest block. */
+        std::uint64_t oversized_allocations{};
+
+        /* Allocations left to the C library because the pool ran out of spans. */
+        std::uint64_t exhausted_allocations{};
+
+        /* Usage of each size class. */
+        std::array<PoolClassStats, POOL_SIZE_CLASSES> classes{};
+    };
+
+    /**
+     * @brief Lock guarding the central pool lists, which are held for a few instructions at a time.
+     *
+     * A contended lock spins briefly, then waits on a futex, so a real-time thread waiting for it
+     * does not keep a lower priority holder on the same CPU from releasing it.
+     */
+    class PoolLock
+    {
+      public:
+        void lock() noexcept;
+        void unlock() noexcept;
+
+      private:
+        /* Lock state: unlocked, locked, or locked with threads waiting on the futex. */
+        std::atomic<std::uint32_t> state_{};
+    };
+
+    /**
+     * @brief Process-wide pooled allocator behind the launcher \c malloc.
+     *
+     * The pool reserves one address range and splits it into spans, each serving blocks of a
+     * single size class. Every thread keeps a cache of free blocks per size class, so most
+     * allocations and frees touch no shared state; the caches exchange batches of blocks with
+     * the central lists of the spans. The small classes, 16 byte steps up to 256 bytes, serve
+     * the many fixed-size engine allocations such as entity private data and strings without
+     * rounding them up to a power of two.
+     *
+     * Memory is never handed back to the C library: a span whose blocks are all freed goes to
+     * the free spans, shared by all classes, and \c trim() releases the pages of the free spans
+     * to the system, keeping the address space reserved.
+     */
+    class PoolAllocator
+    {
+      public:
+        /**
+         * @brief Reserves the pool address range and starts serving allocations.
+         *
+         * @return \c true if the pool is enabled, otherwise \c false
+         */
+        bool enable(std::size_t size);
+
+        /**
+         * @brief Returns true if the pool serves allocations.
+         */
+        [[nodiscard]] bool enabled() const noexcept;
+
+        /**
+         * @brief Returns true if the pointer was allocated by the pool.
+         */
+        [[nodiscard]] bool owns(const void* pointer) const noexcept;
+
+        /**
+         * @brief Allocates a block holding the size.
+         *
+         * @return Pointer to the block, or \c nullptr if the size exceeds \c POOL_MAX_BLOCK_SIZE
+         * or the pool is exhausted
+         */
+        [[nodiscard]] void* allocate(std::size_t size) noexcept;
+
+        /**
+         * @brief Frees a block owned by the pool.
+         */
+        void deallocate(void* pointer) noexcept;
+
+        /**
+         * @brief Returns the usable size of a block owned by the pool.
+         */
+        [[nodiscard]] std::size_t block_size(const void* pointer) const noexcept;
+
+        /**
+         * @brief Returns the free blocks held by the calling thread to the central lists.
+         */
+        void flush_thread_cache() noexcept;
+
+        /**
+         * @brief Returns the pages of the free spans to the system.
+         *
+         * @return Number of the released bytes.
+         */
+        std::size_t trim() noexcept;
+
+        /**
+         * @brief Returns true if the pool is trimmed when the server changes the map.
+         */
+        [[nodiscard]] bool trim_on_map_change() const noexcept;
+
+        /**
+         * @brief Sets whether the pool is trimmed when the server changes the map.
+         */
+        void set_trim_on_map_change(bool trim) noexcept;
+
+        /**
+         * @brief Returns the pool usage.
+         */
+        [[nodiscard]] PoolStats stats() noexcept;
+
+        /**
+         * @brief Locks the central lists around \c fork, so the child does not inherit a held lock.
+         */
+        void lock_all() noexcept;
+
+        /**
+         * @brief Unlocks the central lists after \c fork.
+         */
+        void unlock_all() noexcept;
+
+      private:
+        /* Free block, linked through its first bytes. */
+        struct Block
+        {
+            Block* next;
+        };
+
+        /* Bookkeeping of a span, kept apart from the span memory. */
+        struct Span
+        {
+            /* Freed blocks of the span. */
+            Block* free_list;
+
+            /* Previous span in the list of the span. */
+            Span* prev;
+
+            /* Next span in the list of the span. */
+            Span* next;
+
+            /* Blocks handed out. */
+            std::uint32_t used;
+
+            /* Blocks carved from the span memory so far. */
+            std::uint32_t carved;
+
+            /* Size class owning the span, or POOL_SIZE_CLASSES when the span is free. */
+            std::uint32_t size_class;
+
+            /* Is the span in the partial list of its class? */
+            bool partial;
+
+            /* Were the span pages returned to the system? */
+            bool released;
+        };
+
+        /* Free blocks kept by a thread. */
+        struct ThreadCache;
+
+        /* Central state of a size class. */
+        struct SizeClass
+        {
+            /* Guards the class and its spans. */
+            PoolLock lock{};
+
+            /* Spans with blocks available. */
+            Span* partial{};
+
+            /* Spans owned by the class. */
+            std::size_t spans{};
+
+            /* Blocks handed out. */
+            std::size_t used_blocks{};
+        };
+
+        /* Is the pool serving allocations? */
+        std::atomic<bool> enabled_{};
+
+        /* Is the pool trimmed on map changes? */
+        std::atomic<bool> trim_on_map_change_{};
+
+        /* First address of the pool. */
+        std::atomic<std::uintptr_t> begin_{};
+
+        /* Address past the end of the pool. */
+        std::atomic<std::uintptr_t> end_{};
+
+        /* Span bookkeeping, one entry per span of the pool. */
+        Span* spans_{};
+
+        /* Number of the spans of the pool. */
+        std::size_t span_count_{};
+
+        /* Guards the free spans and the span counters. */
+        PoolLock span_lock_{};
+
+        /* Spans owned by no class. */
+        Span* free_spans_{};
+
+        /* Spans taken from the pool so far; the spans past it were never touched. */
+        std::size_t spans_taken_{};
+
+        /* Number of the free spans. */
+        std::size_t free_span_count_{};
+
+        /* Number of the spans whose pages were returned to the system. */
+        std::size_t released_spans_{};
+
+        /* Memory returned to the system so far. */
+        std::uint64_t released_bytes_{};
+
+        /* Number of the trims. */
+        std::uint64_t trims_{};
+
+        /* Allocations exceeding the largest block. */
+        std::atomic<std::uint64_t> oversized_{};
+
+        /* Allocations that found the pool exhausted. */
+        std::atomic<std::uint64_t> exhausted_{};
+
+        /* Central state of the size classes. */
+        std::array<SizeClass, POOL_SIZE_CLASSES> classes_{};
+
+        /* Free blocks kept by the calling thread. */
+        static thread_local ThreadCache thread_cache_;
+
+        /* Returns the span holding an owned pointer. */
+        [[nodiscard]] Span& span_of(const void* pointer) const noexcept;
+
+        /* Returns the first address of a span. */
+        [[nodiscard]] std::uintptr_t span_address(const Span& span) const noexcept;
+
+        /* Moves up to count blocks of a class to a list; returns the number of the moved blocks. */
+        std::size_t take_blocks(std::size_t size_class, std::size_t count, Block*& list) noexcept;
+
+        /* Returns a list of blocks of a class to their spans. */
+        void return_blocks(std::size_t size_class, Block* list) noexcept;
+
+        /* Takes a free or an untouched span for a class. */
+        Span* take_span(std::size_t size_class) noexcept;
+
+        /* Adds a span, whose blocks are all freed, to the free spans. */
+        void release_span(Span& span) noexcept;
+
+        /* Adds a span to the front of a list. */
+        static void push_span(Span*& head, Span& span) noexcept;
+
+        /* Removes a span from a list. */
+        static void remove_span(Span*& head, Span& span) noexcept;
+
+        /* Makes the calling thread release its cache at exit. */
+        static void register_thread_cache() noexcept;
+
+        /* Releases the thread cache at thread exit. */
+        static void thread_exit(void* cache) noexcept;
+    };
+
+    /**
+     * @brief Returns the process-wide pool allocator.
+     */
+    [[nodiscard]] PoolAllocator& get_pool_allocator() noexcept;
+
+    /**
+     * @brief Handler of the \c hlds_poolstats console command.
+     */
+    void pool_stats_command(const std::string& args);
+
+    inline bool PoolAllocator::enabled() const noexcept
+    {
+        return enabled_.load(std::memory_order_acquire);
+    }
+
+    inline bool PoolAllocator::owns(const void* const pointer) const noexcept
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(pointer);
+
+        return (address >= begin_.load(std::memory_order_relaxed)) && (address < end_.load(std::memory_order_relaxed));
+    }
+
+    inline bool PoolAllocator::trim_on_map_change() const noexcept
+    {
+        return trim_on_map_change_.load(std::memory_order_relaxed);
+    }
+
+    inline void PoolAllocator::set_trim_on_map_change(const bool trim) noexcept
+    {
+        trim_on_map_change_.store(trim, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,194 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "heap_profiler.h"
+#include "pool_allocator.h"
+#include <dlfcn.h>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+// The launcher executable defines the malloc family, so the C library, the engine and every module
+// it loads bind to these definitions. They forward to the glibc allocator until -poolalloc enables
+// the pool; the blocks of either allocator are told apart by address, so each is freed by its owner.
+// With -heapprofile, the allocations and frees are also fed to the heap profiler.
+
+// The tree is built with hidden visibility, and only the functions the C headers declare inherit
+// the default one, so every replacement is exported explicitly.
+#define MALLOC_EXPORT [[gnu::visibility("default")]]
+
+extern "C"
+{
+    void* __libc_malloc(std::size_t size) noexcept;
+    void* __libc_calloc(std::size_t count, std::size_t size) noexcept;
+    void* __libc_realloc(void* pointer, std::size_t size) noexcept;
+    void __libc_free(void* pointer) noexcept;
+}
+
+namespace
+{
+    using rehlds::dedicated::get_heap_profiler;
+    using rehlds::dedicated::get_pool_allocator;
+
+    using UsableSizeFn = std::size_t (*)(void*);
+
+    /* The C library malloc_usable_size, resolved on first use. */
+    std::atomic<UsableSizeFn> libc_usable_size{};
+
+    [[nodiscard]] void* allocate(const std::size_t size) noexcept
+    {
+        if (auto& pool = get_pool_allocator(); pool.enabled()) {
+            if (auto* const pointer = pool.allocate(size); nullptr != pointer) {
+                return pointer;
+            }
+        }
+
+        return __libc_malloc(size);
+    }
+
+    void deallocate(void* const pointer) noexcept
+    {
+        if (auto& pool = get_pool_allocator(); pool.owns(pointer)) {
+            pool.deallocate(pointer);
+        }
+        else {
+            __libc_free(pointer);
+        }
+    }
+
+    [[nodiscard]] void* allocate_zeroed(const std::size_t count, const std::size_t size) noexcept
+    {
+        if (!get_pool_allocator().enabled()) {
+            return __libc_calloc(count, size);
+        }
+
+        if ((0 != size) && (count > std::numeric_limits<std::size_t>::max() / size)) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+
+        const auto total = count * size;
+        auto* const pointer = allocate(total);
+
+        if (nullptr != pointer) {
+            std::memset(pointer, 0, total);
+        }
+
+        return pointer;
+    }
+
+    [[nodiscard]] void* reallocate(void* const pointer, const std::size_t size) noexcept
+    {
+        auto& pool = get_pool_allocator();
+
+        if (!pool.owns(pointer)) {
+            return (nullptr == pointer) ? allocate(size) : __libc_realloc(pointer, size);
+        }
+
+        if (0 == size) {
+            pool.deallocate(pointer);
+            return nullptr;
+        }
+
+        const auto block_size = pool.block_size(pointer);
+
+        if (size <= block_size) {
+            return pointer;
+        }
+
+        auto* const moved = allocate(size);
+
+        if (nullptr != moved) {
+            std::memcpy(moved, pointer, block_size);
+            pool.deallocate(pointer);
+        }
+
+        return moved;
+    }
+
+    void record_allocation(void* const pointer, const std::size_t size) noexcept
+    {
+        if (auto& profiler = get_heap_profiler(); profiler.enabled() && (nullptr != pointer)) {
+            profiler.record_allocation(pointer, size);
+        }
+    }
+
+    rehlds::dedicated::HeapProfiler::Sample record_free(void* const pointer) noexcept
+    {
+        if (auto& profiler = get_heap_profiler(); profiler.enabled()) {
+            return profiler.record_free(pointer);
+        }
+
+        return {};
+    }
+}
+
+extern "C"
+{
+    MALLOC_EXPORT void* malloc(const std::size_t size) noexcept
+    {
+        auto* const pointer = allocate(size);
+        record_allocation(pointer, size);
+
+        return pointer;
+    }
+
+    MALLOC_EXPORT void free(void* const pointer) noexcept
+    {
+        record_free(pointer);
+        deallocate(pointer);
+    }
+
+    MALLOC_EXPORT void* calloc(const std::size_t count, const std::size_t size) noexcept
+    {
+        auto* const pointer = allocate_zeroed(count, size);
+        record_allocation(pointer, count * size);
+
+        return pointer;
+    }
+
+    MALLOC_EXPORT void* realloc(void* const pointer, const std::size_t size) noexcept
+    {
+        // The block may be reused by another thread as soon as it is freed, so its sample goes first
+        // and is put back if the block stays allocated because the reallocation failed
+        const auto sample = record_free(pointer);
+        auto* const moved = reallocate(pointer, size);
+
+        if ((nullptr == moved) && (0 != size)) {
+            get_heap_profiler().restore(sample);
+        }
+
+        record_allocation(moved, size);
+
+        return moved;
+    }
+
+    MALLOC_EXPORT void* reallocarray(void* const pointer, const std::size_t count, const std::size_t size) noexcept
+    {
+        if ((0 != size) && (count > std::numeric_limits<std::size_t>::max() / size)) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+
+        return realloc(pointer, count * size);
+    }
+
+    MALLOC_EXPORT std::size_t malloc_usable_size(void* const pointer) noexcept
+    {
+        if (auto& pool = get_pool_allocator(); pool.owns(pointer)) {
+            return pool.block_size(pointer);
+        }
+
+        auto usable_size = libc_usable_size.load(std::memory_order_acquire);
+
+        if (nullptr == usable_size) {
+            usable_size = reinterpret_cast<UsableSizeFn>(::dlsym(RTLD_NEXT, "malloc_usable_size"));
+            libc_usable_size.store(usable_size, std::memory_order_release);
+        }
+
+        return (nullptr == usable_size) ? 0 : usable_size(pointer);
+    }
+}
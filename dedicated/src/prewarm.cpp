@@ -0,0 +1,148 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "prewarm.h"
+#include "arguments.h"
+#include "common/hlds_module.h"
+#include "console/text_console.h"
+#include "cpputils/string.h"
+#include "cpputils/trace.h"
+#include "realtime.h"
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <pthread.h>
+#include <unistd.h>
+#include <utility>
+
+namespace rehlds::dedicated
+{
+    Prewarmer::~Prewarmer()
+    {
+        stop();
+    }
+
+    void Prewarmer::start(std::vector<std::string> paths)
+    {
+        stop();
+
+        paths_ = std::move(paths);
+        next_path_.store(0, std::memory_order_relaxed);
+        stopping_.store(false, std::memory_order_relaxed);
+
+        for (std::size_t i = 0; i < PREWARM_THREADS; ++i) {
+            threads_.emplace_back(&Prewarmer::run, this);
+        }
+    }
+
+    void Prewarmer::wait()
+    {
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+
+        threads_.clear();
+    }
+
+    void Prewarmer::stop()
+    {
+        stopping_.store(true, std::memory_order_relaxed);
+        wait();
+    }
+
+    void Prewarmer::run()
+    {
+        ::pthread_setname_np(::pthread_self(), "hlds-prewarm");
+        set_background_thread_policy();
+
+        while (!stopping_.load(std::memory_order_relaxed)) {
+            const auto index = next_path_.fetch_add(1, std::memory_order_relaxed);
+
+            if (index >= paths_.size()) {
+                break;
+            }
+
+            read_ahead(paths_[index]);
+        }
+    }
+
+    void Prewarmer::read_ahead(const std::string& path)
+    {
+        std::error_code error{};
+
+        if (!std::filesystem::is_directory(path, error)) {
+            read_file(path);
+            return;
+        }
+
+        const auto options = std::filesystem::directory_options::skip_permission_denied;
+
+        for (std::filesystem::recursive_directory_iterator it{path, options, error}, end{}; it != end;
+             it.increment(error)) {
+            if (stopping_.load(std::memory_order_relaxed)) {
+                break;
+            }
+
+            if (it->is_regular_file(error)) {
+                read_file(it->path().string());
+            }
+        }
+    }
+
+    void Prewarmer::read_file(const std::string& path)
+    {
+        const cpputils::TraceSpan span{"readahead", "prewarm", path};
+        const auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (descriptor < 0) {
+            return;
+        }
+
+        if (struct stat status{}; (0 == ::fstat(descriptor, &status)) && (status.st_size > 0)) {
+            const auto size = static_cast<std::size_t>(status.st_size);
+
+            // Some filesystems do not implement readahead but still honor the advice
+            if ((0 == ::readahead(descriptor, 0, size)) ||
+                (0 == ::posix_fadvise(descriptor, 0, status.st_size, POSIX_FADV_WILLNEED))) {
+                files_.fetch_add(1, std::memory_order_relaxed);
+                bytes_.fetch_add(size, std::memory_order_relaxed);
+            }
+        }
+
+        ::close(descriptor);
+    }
+
+    std::vector<std::string> prewarm_paths(const CommandLine& cmdline, const std::string& list_file)
+    {
+        std::vector<std::string> paths{common::ENGINE_MODULE_FILE, common::FILESYSTEM_MODULE_FILE};
+
+        if (auto game_module = game_module_path(cmdline); !game_module.empty()) {
+            paths.push_back(std::move(game_module));
+        }
+
+        if (list_file.empty()) {
+            return paths;
+        }
+
+        std::ifstream file{list_file};
+
+        if (!file.good()) {
+            TextConsole::print("WARNING! -prewarm: Unable to open \"{}\".\n", list_file);
+            return paths;
+        }
+
+        std::string line{};
+
+        while (std::getline(file, line)) {
+            line = cpputils::trim(line);
+
+            if ((!line.empty()) && ('#' != line.front())) {
+                paths.push_back(std::move(line));
+            }
+        }
+
+        return paths;
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "command_line.h"
+#include "cpputils/singleton_holder.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Number of the threads reading the files ahead.
+     */
+    constexpr std::size_t PREWARM_THREADS = 4;
+
+    /**
+     * @brief Reads files into the page cache on background threads.
+     *
+     * Each file is handed to \c readahead, so the later \c dlopen or file access of the engine
+     * finds its pages cached instead of faulting them in one at a time. The files are taken
+     * in the order given, so the modules needed first should be listed first.
+     */
+    class Prewarmer
+    {
+      public:
+        Prewarmer() = default;
+        Prewarmer(Prewarmer&&) = delete;
+        Prewarmer(const Prewarmer&) = delete;
+        Prewarmer& operator=(Prewarmer&&) = delete;
+        Prewarmer& operator=(const Prewarmer&) = delete;
+        ~Prewarmer();
+
+        /**
+         * @brief Starts reading the files ahead; a directory is read recursively.
+         */
+        void start(std::vector<std::string> paths);
+
+        /**
+         * @brief Waits until all files are read ahead.
+         */
+        void wait();
+
+        /**
+         * @brief Asks the threads to stop after their current file and waits for them.
+         */
+        void stop();
+
+        /**
+         * @brief Returns the number of the files read ahead.
+         */
+        [[nodiscard]] std::size_t files() const noexcept;
+
+        /**
+         * @brief Returns the number of the bytes read ahead.
+         */
+        [[nodiscard]] std::uint64_t bytes() const noexcept;
+
+      private:
+        /* Files and directories to read ahead. */
+        std::vector<std::string> paths_{};
+
+        /* Index of the next path to take. */
+        std::atomic<std::size_t> next_path_{};
+
+        /* Number of the files read ahead. */
+        std::atomic<std::size_t> files_{};
+
+        /* Number of the bytes read ahead. */
+        std::atomic<std::uint64_t> bytes_{};
+
+        /* Are the threads asked to stop? */
+        std::atomic<bool> stopping_{};
+
+        /* Reading threads. */
+        std::vector<std::thread> threads_{};
+
+        /* Thread entry point. */
+        void run();
+
+        /* Reads a file ahead, or every file of a directory. */
+        void read_ahead(const std::string& path);
+
+        /* Reads a regular file ahead. */
+        void read_file(const std::string& path);
+    };
+
+    /**
+     * @brief Returns a prewarmer instance.
+     */
+    [[nodiscard]] inline Prewarmer& get_prewarmer()
+    {
+        return cpputils::SingletonHolder<Prewarmer>::get_instance();
+    }
+
+    /**
+     * @brief Returns the files to prewarm for the command line: the engine, filesystem and game modules,
+     * followed by the paths listed in the specified file, one per line.
+     */
+    [[nodiscard]] std::vector<std::string> prewarm_paths(const CommandLine& cmdline, const std::string& list_file);
+
+    inline std::size_t Prewarmer::files() const noexcept
+    {
+        return files_.load(std::memory_order_relaxed);
+    }
+
+    inline std::uint64_t Prewarmer::bytes() const noexcept
+    {
+        return bytes_.load(std::memory_order_relaxed);
+    }
+}
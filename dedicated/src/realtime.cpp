@@ -0,0 +1,278 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "realtime.h"
+#include "cpputils/format.h"
+#include "cpputils/string.h"
+#include <sys/mman.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    /* Amount of stack faulted in by prefault_memory(). */
+    constexpr std::size_t PREFAULT_STACK_SIZE = 256 * 1024;
+
+    /* Size of the heap blocks faulted in by prefault_memory(), below the default mmap threshold of malloc(). */
+    constexpr std::size_t PREFAULT_BLOCK_SIZE = 64 * 1024;
+
+    [[nodiscard]] bool parse_cpu(const std::string& text, int& cpu)
+    {
+        if (text.empty() || (!cpputils::is_digit(text))) {
+            return false;
+        }
+
+        cpu = static_cast<int>(std::strtol(text.c_str(), nullptr, 10));
+        return (cpu >= 0) && (cpu < CPU_SETSIZE);
+    }
+
+    [[nodiscard]] bool parse_cpu_list(const std::string& cpus, ::cpu_set_t& cpu_set)
+    {
+        CPU_ZERO(&cpu_set);
+        std::string::size_type start = 0;
+
+        while (start <= cpus.length()) {
+            const auto end = std::min(cpus.find(',', start), cpus.length());
+            const auto range = cpputils::trim(cpus.substr(start, end - start));
+            const auto dash = range.find('-');
+            int first = 0;
+            int last = 0;
+
+            if (std::string::npos == dash) {
+                if (!parse_cpu(range, first)) {
+                    return false;
+                }
+
+                last = first;
+            }
+            else if ((!parse_cpu(range.substr(0, dash), first)) || (!parse_cpu(range.substr(dash + 1), last)) ||
+                     (first > last)) {
+                return false;
+            }
+
+            for (auto cpu = first; cpu <= last; ++cpu) {
+                CPU_SET(static_cast<std::size_t>(cpu), &cpu_set);
+            }
+
+            start = end + 1;
+        }
+
+        return CPU_COUNT(&cpu_set) > 0;
+    }
+
+    /* Has set_thread_affinity() pinned a server thread? */
+    std::atomic_bool thread_pinned{};
+
+    /* Returns the CPUs the process was allowed to run on before the first server thread was pinned. */
+    [[nodiscard]] const ::cpu_set_t& process_affinity()
+    {
+        static const auto cpu_set = []
+        {
+            ::cpu_set_t result{};
+
+            if (0 != ::pthread_getaffinity_np(::pthread_self(), sizeof(result), &result)) {
+                CPU_ZERO(&result);
+            }
+
+            return result;
+        }();
+
+        return cpu_set;
+    }
+
+    void prefault_stack()
+    {
+        // Zero-initializing a volatile array writes to every page of it
+        [[maybe_unused]] const std::array<volatile unsigned char, PREFAULT_STACK_SIZE> stack{};
+    }
+}
+
+namespace rehlds::dedicated
+{
+    bool set_thread_affinity(const std::string& cpus)
+    {
+        ::cpu_set_t cpu_set{};
+
+        if (!parse_cpu_list(cpus, cpu_set)) {
+            errno = EINVAL;
+            return false;
+        }
+
+        // Saved before the first thread is pinned, as the set the background threads are confined to
+        [[maybe_unused]] const auto& allowed = process_affinity();
+
+        if (const auto error = ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set); error != 0) {
+            errno = error;
+            return false;
+        }
+
+        thread_pinned.store(true, std::memory_order_release);
+        return true;
+    }
+
+    std::string get_thread_affinity()
+    {
+        ::cpu_set_t cpu_set{};
+
+        if (0 != ::pthread_getaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set)) {
+            return "unknown";
+        }
+
+        std::string result{};
+
+        for (auto cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (!CPU_ISSET(static_cast<std::size_t>(cpu), &cpu_set)) {
+                continue;
+            }
+
+            auto last = cpu;
+
+            while (((last + 1) < CPU_SETSIZE) && CPU_ISSET(static_cast<std::size_t>(last + 1), &cpu_set)) {
+                ++last;
+            }
+
+            if (!result.empty()) {
+                result.push_back(',');
+            }
+
+            result += cpu == last ? std::to_string(cpu) : cpputils::format("{}-{}", cpu, last);
+            cpu = last;
+        }
+
+        return result;
+    }
+
+    bool set_thread_scheduler(const std::string& policy, const int priority)
+    {
+        int policy_id = 0;
+
+        if (cpputils::equal_ignore_case(policy, "fifo")) {
+            policy_id = SCHED_FIFO;
+        }
+        else if (cpputils::equal_ignore_case(policy, "rr")) {
+            policy_id = SCHED_RR;
+        }
+        else {
+            errno = EINVAL;
+            return false;
+        }
+
+        const auto min_priority = ::sched_get_priority_min(policy_id);
+        const auto max_priority = ::sched_get_priority_max(policy_id);
+
+        ::sched_param param{};
+        param.sched_priority = std::clamp(priority, min_priority, max_priority);
+
+        if (const auto error = ::pthread_setschedparam(::pthread_self(), policy_id, &param); error != 0) {
+            errno = error;
+            return false;
+        }
+
+        return true;
+    }
+
+    std::string get_thread_scheduler()
+    {
+        int policy = 0;
+        ::sched_param param{};
+
+        if (0 != ::pthread_getschedparam(::pthread_self(), &policy, &param)) {
+            return "unknown";
+        }
+
+        switch (policy) {
+            case SCHED_FIFO: return cpputils::format("SCHED_FIFO priority {}", param.sched_priority);
+            case SCHED_RR: return cpputils::format("SCHED_RR priority {}", param.sched_priority);
+            case SCHED_OTHER: return "SCHED_OTHER";
+            default: return cpputils::format("policy {} priority {}", policy, param.sched_priority);
+        }
+    }
+
+    void set_background_thread_policy()
+    {
+        ::sigset_t signals{};
+        ::sigfillset(&signals);
+        ::pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        ::sched_param param{};
+        ::pthread_setschedparam(::pthread_self(), SCHED_OTHER, &param);
+
+        // Without -cpuaffinity the threads keep the affinity the operator gave the process
+        if (!thread_pinned.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        ::cpu_set_t reserved{};
+        ::cpu_set_t available{};
+
+        if (0 != ::pthread_getaffinity_np(::pthread_self(), sizeof(reserved), &reserved)) {
+            return;
+        }
+
+        const auto& allowed = process_affinity();
+        CPU_ZERO(&available);
+
+        for (std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed) && (!CPU_ISSET(cpu, &reserved))) {
+                CPU_SET(cpu, &available);
+            }
+        }
+
+        if (CPU_COUNT(&available) > 0) {
+            ::pthread_setaffinity_np(::pthread_self(), sizeof(available), &available);
+        }
+    }
+
+    bool lock_memory()
+    {
+        return 0 == ::mlockall(MCL_CURRENT | MCL_FUTURE);
+    }
+
+    bool disable_heap_mappings()
+    {
+        return 0 != ::mallopt(M_MMAP_MAX, 0);
+    }
+
+    void prefault_memory(const std::size_t heap_size)
+    {
+        // Keep freed memory in the heap, so the faulted-in pages stay resident
+        ::mallopt(M_TRIM_THRESHOLD, -1);
+
+        // Small blocks come from the heap even while malloc() serves large ones from fresh mappings
+        std::vector<unsigned char*> blocks{};
+        blocks.reserve(heap_size / PREFAULT_BLOCK_SIZE);
+        const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+        for (std::size_t size = 0; size < heap_size; size += PREFAULT_BLOCK_SIZE) {
+            // NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+            auto* const block = static_cast<unsigned char*>(std::malloc(PREFAULT_BLOCK_SIZE));
+
+            if (nullptr == block) {
+                break;
+            }
+
+            for (std::size_t i = 0; i < PREFAULT_BLOCK_SIZE; i += page_size) {
+                static_cast<volatile unsigned char*>(block)[i] = 0;
+            }
+
+            blocks.push_back(block);
+        }
+
+        for (auto* const block : blocks) {
+            std::free(block); // NOLINT(cppcoreguidelines-no-malloc)
+        }
+
+        prefault_stack();
+    }
+}
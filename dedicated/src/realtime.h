@@ -0,0 +1,72 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Pins the calling thread to the specified CPUs.
+     *
+     * @param cpus Comma-separated list of CPU numbers and ranges, e.g. "2,4-5".
+     *
+     * @return \c true if the affinity was applied, otherwise \c false
+     */
+    bool set_thread_affinity(const std::string& cpus);
+
+    /**
+     * @brief Returns the CPUs the calling thread may run on, formatted as a list of ranges.
+     */
+    [[nodiscard]] std::string get_thread_affinity();
+
+    /**
+     * @brief Sets a real-time scheduling policy for the calling thread.
+     *
+     * @param policy Scheduling policy name: "fifo" or "rr".
+     * @param priority Static priority within the policy range.
+     *
+     * @return \c true if the policy was applied, otherwise \c false
+     */
+    bool set_thread_scheduler(const std::string& policy, int priority);
+
+    /**
+     * @brief Returns the scheduling policy and priority of the calling thread.
+     */
+    [[nodiscard]] std::string get_thread_scheduler();
+
+    /**
+     * @brief Moves the calling helper thread out of the way of the server loop.
+     *
+     * Blocks the signals, so they are delivered to the server loop, resets the scheduling policy
+     * inherited from the main thread to \c SCHED_OTHER, and, if a server thread was pinned by
+     * set_thread_affinity(), moves the thread to the CPUs of the original process affinity
+     * the server thread is not pinned to, if there are any.
+     */
+    void set_background_thread_policy();
+
+    /**
+     * @brief Locks all current and future pages of the process into RAM.
+     *
+     * @return \c true if the memory was locked, otherwise \c false
+     */
+    bool lock_memory();
+
+    /**
+     * @brief Makes malloc() serve all blocks from the heap instead of mapping large ones separately.
+     *
+     * @return \c true if the setting was applied, otherwise \c false
+     */
+    bool disable_heap_mappings();
+
+    /**
+     * @brief Faults in the specified amount of heap and stack memory, so the server loop
+     * does not take page faults on the first allocations after the engine initialization.
+     *
+     * The heap is kept from being trimmed, so the prefaulted pages stay resident.
+     */
+    void prefault_memory(std::size_t heap_size);
+}
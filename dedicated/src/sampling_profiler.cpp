@@ -0,0 +1,410 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "sampling_profiler.h"
+#include "clock.h"
+#include "common/hlds_module.h"
+#include "console/text_console.h"
+#include "cpputils/format.h"
+#include "cpputils/string.h"
+#include "cpputils/system.h"
+#include "realtime.h"
+#include "symbolizer.h"
+#include <sys/syscall.h>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <link.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <pthread.h>
+#include <unistd.h>
+#include <utility>
+
+// Older glibc headers only declare the union member
+#ifndef sigev_notify_thread_id
+  #define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+using namespace rehlds::common;
+
+namespace
+{
+    using rehlds::dedicated::SamplingProfiler;
+    using rehlds::dedicated::Symbol;
+
+    /* Interval of the ring buffer draining. */
+    constexpr std::chrono::milliseconds DRAIN_INTERVAL{100};
+
+    /* Frames of the signal handler and of the signal trampoline on top of a sampled stack. */
+    constexpr std::size_t SKIPPED_FRAMES = 2;
+
+    /* Highest sampling frequency. */
+    constexpr int MAX_FREQUENCY = 10'000;
+
+    /* Profiler the signal handler stores the samples to. */
+    std::atomic<SamplingProfiler*> active_profiler{};
+
+    /* Returns the link map of the module containing the address. */
+    [[nodiscard]] ::link_map* find_link_map(const void* const address) noexcept
+    {
+        ::Dl_info info{};
+        ::link_map* map = nullptr;
+
+        return 0 == ::dladdr1(address, &info, reinterpret_cast<void**>(&map), RTLD_DL_LINKMAP) ? nullptr : map;
+    }
+
+    /* Returns the link map of a loaded module without loading it. */
+    [[nodiscard]] ::link_map* find_loaded_link_map(const char* const path) noexcept
+    {
+        auto* const handle = ::dlopen(path, RTLD_NOW | RTLD_NOLOAD);
+        ::link_map* map = nullptr;
+
+        if (nullptr != handle) {
+            if (0 != ::dlinfo(handle, RTLD_DI_LINKMAP, &map)) {
+                map = nullptr;
+            }
+
+            ::dlclose(handle);
+        }
+
+        return map;
+    }
+
+    [[nodiscard]] std::string demangle(const std::string& name)
+    {
+        auto status = 0;
+        auto* const demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+
+        if (nullptr == demangled) {
+            return name;
+        }
+
+        std::string result{demangled};
+        std::free(demangled); // NOLINT(cppcoreguidelines-no-malloc)
+
+        return result;
+    }
+
+    /**
+     * @brief Names the frames of the sampled stacks after their component and function.
+     */
+    class FrameNamer
+    {
+      public:
+        explicit FrameNamer(const std::string& game_module)
+          : launcher_(find_loaded_link_map(nullptr)),
+            game_(game_module.empty() ? nullptr : find_loaded_link_map(game_module.c_str()))
+        {
+        }
+
+        FrameNamer(FrameNamer&&) = delete;
+        FrameNamer(const FrameNamer&) = delete;
+        FrameNamer& operator=(FrameNamer&&) = delete;
+        FrameNamer& operator=(const FrameNamer&) = delete;
+        ~FrameNamer() = default;
+
+        [[nodiscard]] const std::string& name(void* const address)
+        {
+            auto& name = names_[address];
+
+            if (name.empty()) {
+                Symbol symbol{};
+                symbolize(address, symbol);
+
+                const auto function = symbol.function.empty() ? symbol.location : demangle(symbol.function);
+                name = cpputils::format("{}`{}", component(address, symbol), function);
+            }
+
+            return name;
+        }
+
+      private:
+        /* Link map of the launcher executable. */
+        ::link_map* launcher_;
+
+        /* Link map of the game module, null if it is unknown. */
+        ::link_map* game_;
+
+        /* Names of the already named frames. */
+        std::map<void*, std::string> names_{};
+
+        [[nodiscard]] std::string component(const void* const address, const Symbol& symbol) const
+        {
+            if (get_engine_module().contains(address)) {
+                return "engine";
+            }
+
+            if (get_filesystem_module().contains(address)) {
+                return "filesystem";
+            }
+
+            const auto* const map = find_link_map(address);
+
+            if ((nullptr != map) && (game_ == map)) {
+                return "game";
+            }
+
+            if ((nullptr != map) && (launcher_ == map)) {
+                return "launcher";
+            }
+
+            return symbol.module;
+        }
+    };
+}
+
+namespace rehlds::dedicated
+{
+    SamplingProfiler::~SamplingProfiler()
+    {
+        stop();
+    }
+
+    void SamplingProfiler::set_game_module(std::string path)
+    {
+        game_module_ = std::move(path);
+    }
+
+    bool SamplingProfiler::start(const int frequency, const int duration, std::string path)
+    {
+        if (running()) {
+            return false;
+        }
+
+        // Joins the collector of the previous profile, which ended by itself
+        stop();
+
+        // The first backtrace loads the unwinder, which must not happen in the signal handler
+        std::array<void*, 1> frames{};
+        ::backtrace(frames.data(), static_cast<int>(frames.size()));
+
+        if (!ring_) {
+            ring_ = std::make_unique<Sample[]>(PROFILE_RING_SIZE);
+        }
+
+        struct sigaction action{};
+        action.sa_handler = &SamplingProfiler::take_sample;
+        action.sa_flags = SA_RESTART;
+        ::sigemptyset(&action.sa_mask);
+
+        ::clockid_t clock{};
+        ::sigevent event{};
+        event.sigev_notify = SIGEV_THREAD_ID;
+        event.sigev_signo = SIGPROF;
+        event.sigev_notify_thread_id = static_cast<::pid_t>(::syscall(SYS_gettid));
+
+        if ((0 != ::sigaction(SIGPROF, &action, nullptr)) || (0 != ::pthread_getcpuclockid(::pthread_self(), &clock)) ||
+            (0 != ::timer_create(clock, &event, &timer_))) {
+            return false;
+        }
+
+        frequency_ = std::clamp(frequency, 1, MAX_FREQUENCY);
+        duration_ = std::max(duration, 1);
+        path_ = std::move(path);
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+        samples_.store(0, std::memory_order_relaxed);
+        stacks_.clear();
+        active_profiler.store(this, std::memory_order_release);
+
+        ::itimerspec interval{};
+        interval.it_interval = to_timespec(NANOSECONDS_PER_SECOND / frequency_);
+        interval.it_value = interval.it_interval;
+        ::timer_settime(timer_, 0, &interval, nullptr);
+
+        stopping_ = false;
+        active_.store(true, std::memory_order_release);
+        thread_ = std::thread{&SamplingProfiler::run, this};
+
+        return true;
+    }
+
+    void SamplingProfiler::request_stop()
+    {
+        if (!thread_.joinable()) {
+            return;
+        }
+
+        {
+            const std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+
+        wake_.notify_one();
+    }
+
+    void SamplingProfiler::stop()
+    {
+        request_stop();
+
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void SamplingProfiler::print_status() const
+    {
+        if (running()) {
+            TextConsole::print("Profiler: running at {} Hz for {} s, {} samples, {} dropped, writing to \"{}\".\n",
+              frequency_, duration_, samples_.load(std::memory_order_relaxed),
+              dropped_.load(std::memory_order_relaxed), path_);
+        }
+        else {
+            TextConsole::print("Profiler: stopped.\n");
+        }
+    }
+
+    void SamplingProfiler::run()
+    {
+        ::pthread_setname_np(::pthread_self(), "hlds-profiler");
+        set_background_thread_policy();
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{duration_};
+        std::unique_lock lock{mutex_};
+
+        while ((!wake_.wait_for(lock, DRAIN_INTERVAL, [this] { return stopping_; })) &&
+               (std::chrono::steady_clock::now() < deadline)) {
+            drain();
+        }
+
+        lock.unlock();
+
+        // A signal may still be pending; the handler keeps writing to the ring, which is never freed
+        ::timer_delete(timer_);
+        drain();
+        write();
+        active_.store(false, std::memory_order_release);
+    }
+
+    void SamplingProfiler::drain()
+    {
+        const auto head = head_.load(std::memory_order_acquire);
+
+        for (auto tail = tail_.load(std::memory_order_relaxed); tail != head; ++tail) {
+            const auto& sample = ring_[tail % PROFILE_RING_SIZE];
+
+            if (sample.depth > SKIPPED_FRAMES) {
+                const auto begin = sample.frames.cbegin() + SKIPPED_FRAMES;
+                ++stacks_[std::vector<void*>{begin, sample.frames.cbegin() + sample.depth}];
+                samples_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            tail_.store(tail + 1, std::memory_order_release);
+        }
+    }
+
+    void SamplingProfiler::write() const
+    {
+        // Stacks that differ in the return addresses only add up to the same line
+        FrameNamer namer{game_module_};
+        std::map<std::string, std::size_t> lines{};
+
+        for (const auto& [stack, count] : stacks_) {
+            std::string line{};
+
+            for (auto frame = stack.crbegin(); frame != stack.crend(); ++frame) {
+                if (!line.empty()) {
+                    line.push_back(';');
+                }
+
+                line.append(namer.name(*frame));
+            }
+
+            lines[line] += count;
+        }
+
+        std::ofstream file{path_, std::ios::trunc};
+
+        for (const auto& [line, count] : lines) {
+            file << line << ' ' << count << '\n';
+        }
+
+        if (!file.good()) {
+            TextConsole::print("WARNING! Profiler: Unable to write \"{}\".\n", path_);
+            return;
+        }
+
+        TextConsole::print("Profiler: {} samples of {} stacks written to \"{}\", {} dropped.\n",
+          samples_.load(std::memory_order_relaxed), lines.size(), path_, dropped_.load(std::memory_order_relaxed));
+    }
+
+    void SamplingProfiler::take_sample([[maybe_unused]] const int signal_number)
+    {
+        auto* const profiler = active_profiler.load(std::memory_order_acquire);
+
+        if (nullptr == profiler) {
+            return;
+        }
+
+        const auto saved_errno = errno;
+        const auto head = profiler->head_.load(std::memory_order_relaxed);
+
+        if (head - profiler->tail_.load(std::memory_order_acquire) >= PROFILE_RING_SIZE) {
+            profiler->dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            auto& sample = profiler->ring_[head % PROFILE_RING_SIZE];
+            const auto depth = ::backtrace(sample.frames.data(), static_cast<int>(sample.frames.size()));
+            sample.depth = static_cast<std::size_t>(std::max(depth, 0));
+            profiler->head_.store(head + 1, std::memory_order_release);
+        }
+
+        errno = saved_errno;
+    }
+
+    void profile_command(const std::string& args)
+    {
+        constexpr auto default_frequency = 99;
+        constexpr auto default_duration = 30;
+
+        auto& profiler = get_sampling_profiler();
+        const auto values = cpputils::split(args, " ", cpputils::StringSplitOptions::trim_remove_empty_entries);
+
+        if (values.empty()) {
+            profiler.print_status();
+            return;
+        }
+
+        if (cpputils::equal_ignore_case(values[0], "stop")) {
+            if (!profiler.running()) {
+                TextConsole::print("Profiler: no profile is running.\n");
+            }
+
+            // The collector symbolizes and writes the stacks on its own thread, the next start joins it
+            profiler.request_stop();
+            return;
+        }
+
+        if (!cpputils::equal_ignore_case(values[0], "start")) {
+            TextConsole::print("Usage: hlds_profile [start [frequency] [seconds] [file] | stop]\n");
+            return;
+        }
+
+        const auto value = [&values](const std::size_t index, const int default_value)
+        {
+            return index < values.size() ? std::atoi(values[index].c_str()) : default_value;
+        };
+
+        const auto frequency = value(1, default_frequency);
+        const auto duration = value(2, default_duration);
+        auto path = values.size() > 3 ? values[3] : std::string{"profile.folded"};
+
+        if (profiler.running()) {
+            TextConsole::print("Profiler: a profile is already running.\n");
+        }
+        else if (profiler.start(frequency, duration, path)) {
+            profiler.print_status();
+        }
+        else {
+            TextConsole::print("WARNING! Profiler: Unable to create the sampling timer: {}\n",
+              cpputils::get_last_error_str());
+        }
+    }
+}
@@ -0,0 +1,176 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "cpputils/singleton_holder.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Maximum number of the frames of a sampled stack.
+     */
+    constexpr std::size_t PROFILE_STACK_FRAMES = 64;
+
+    /**
+     * @brief Number of the samples the ring buffer holds until the collector thread drains it.
+     */
+    constexpr std::size_t PROFILE_RING_SIZE = 1024;
+
+    /**
+     * @brief Sampling profiler of the server thread.
+     *
+     * A timer on the CPU clock of the profiled thread sends it \c SIGPROF at the sampling frequency,
+     * and the signal handler stores the stack into a single-producer ring buffer. A collector thread
+     * drains the ring and counts the distinct stacks; when the profile ends, it symbolizes them and
+     * writes the collapsed stacks, one <tt>root;...;leaf count</tt> line per stack, as taken by
+     * \c flamegraph.pl. Each frame is named <tt>component`function</tt>, where the component is
+     * the launcher, engine, filesystem or game module, or the file name of any other module.
+     */
+    class SamplingProfiler
+    {
+      public:
+        SamplingProfiler() = default;
+        SamplingProfiler(SamplingProfiler&&) = delete;
+        SamplingProfiler(const SamplingProfiler&) = delete;
+        SamplingProfiler& operator=(SamplingProfiler&&) = delete;
+        SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+        ~SamplingProfiler();
+
+        /**
+         * @brief Sets the path of the game module, so its frames are attributed to the game.
+         */
+        void set_game_module(std::string path);
+
+        /**
+         * @brief Starts profiling the calling thread.
+         *
+         * @param frequency Samples per second of the thread CPU time.
+         * @param duration Profile duration in seconds; the profile is written when it elapses.
+         * @param path Path of the collapsed stacks file.
+         *
+         * @return \c true if the profile was started, otherwise \c false
+         */
+        bool start(int frequency, int duration, std::string path);
+
+        /**
+         * @brief Asks the collector thread to end the profile and write the collapsed stacks file,
+         * without waiting for it.
+         */
+        void request_stop();
+
+        /**
+         * @brief Ends the profile and waits until the collapsed stacks file is written.
+         */
+        void stop();
+
+        /**
+         * @brief Returns true if a profile is running.
+         */
+        [[nodiscard]] bool running() const noexcept;
+
+        /**
+         * @brief Prints the state of the profile to the console.
+         */
+        void print_status() const;
+
+      private:
+        /* Stack stored by the signal handler. */
+        struct Sample
+        {
+            std::size_t depth;
+            std::array<void*, PROFILE_STACK_FRAMES> frames;
+        };
+
+        /* Path of the game module. */
+        std::string game_module_{};
+
+        /* Path of the collapsed stacks file. */
+        std::string path_{};
+
+        /* Sampling frequency. */
+        int frequency_{};
+
+        /* Profile duration in seconds. */
+        int duration_{};
+
+        /* Sampling timer. */
+        ::timer_t timer_{};
+
+        /* Ring buffer written by the signal handler. */
+        std::unique_ptr<Sample[]> ring_{};
+
+        /* Index of the next sample written by the signal handler. */
+        std::atomic<std::size_t> head_{};
+
+        /* Index of the next sample read by the collector thread. */
+        std::atomic<std::size_t> tail_{};
+
+        /* Number of the samples dropped because the ring was full. */
+        std::atomic<std::size_t> dropped_{};
+
+        /* Number of the collected samples. */
+        std::atomic<std::size_t> samples_{};
+
+        /* Is a profile running? */
+        std::atomic<bool> active_{};
+
+        /* Sample counts of the distinct stacks, leaf first. */
+        std::map<std::vector<void*>, std::size_t> stacks_{};
+
+        /* Wakes the collector thread when the profile is stopped. */
+        std::condition_variable wake_{};
+
+        /* Guards the stop request. */
+        std::mutex mutex_{};
+
+        /* Is the collector thread asked to stop? */
+        bool stopping_{};
+
+        /* Collector thread. */
+        std::thread thread_{};
+
+        /* Collector thread entry point. */
+        void run();
+
+        /* Moves the samples from the ring buffer to the stack counts. */
+        void drain();
+
+        /* Writes the collapsed stacks file. */
+        void write() const;
+
+        /* Signal handler of the sampling timer. */
+        static void take_sample(int signal_number);
+    };
+
+    /**
+     * @brief Returns a sampling profiler instance.
+     */
+    [[nodiscard]] inline SamplingProfiler& get_sampling_profiler()
+    {
+        return cpputils::SingletonHolder<SamplingProfiler>::get_instance();
+    }
+
+    /**
+     * @brief Handler of the \c hlds_profile console command.
+     */
+    void profile_command(const std::string& args);
+
+    inline bool SamplingProfiler::running() const noexcept
+    {
+        return active_.load(std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,313 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "server_host.h"
+#include "arguments.h"
+#include "clock.h"
+#include "commands.h"
+#include "common/interface.h"
+#include "common/interfaces/filesystem.h"
+#include "console/text_console.h"
+#include "cpputils/format.h"
+#include "cpputils/string.h"
+#include "realtime.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <fstream>
+#include <pthread.h>
+#include <utility>
+
+using namespace rehlds::common;
+
+namespace
+{
+    /* Interval of the console polling on the main thread. */
+    constexpr std::chrono::milliseconds CONSOLE_POLL_INTERVAL{10};
+
+    /* Number of the server owning the calling thread, zero on the launcher threads. */
+    thread_local std::size_t server_number = 0;
+
+    /* Does the next text printed by the calling server thread start a new line? */
+    thread_local bool line_start = true;
+
+    [[nodiscard]] const char* state_name(const rehlds::dedicated::HostedServerState state)
+    {
+        using rehlds::dedicated::HostedServerState;
+
+        switch (state) {
+            case HostedServerState::starting:
+                return "starting";
+
+            case HostedServerState::running:
+                return "running";
+
+            case HostedServerState::stopped:
+                return "stopped";
+
+            case HostedServerState::failed:
+                return "failed";
+        }
+
+        return "unknown";
+    }
+}
+
+namespace rehlds::dedicated
+{
+    HostedServer::HostedServer(const std::size_t index, CommandLine cmdline)
+      : index_(index), cmdline_(std::move(cmdline))
+    {
+    }
+
+    HostedServer::~HostedServer()
+    {
+        stop();
+    }
+
+    void HostedServer::start()
+    {
+        if (!thread_.joinable()) {
+            stopping_.store(false, std::memory_order_relaxed);
+            state_.store(HostedServerState::starting, std::memory_order_release);
+            thread_ = std::thread{&HostedServer::run, this};
+        }
+    }
+
+    void HostedServer::stop()
+    {
+        if (thread_.joinable()) {
+            stopping_.store(true, std::memory_order_relaxed);
+            thread_.join();
+        }
+    }
+
+    bool HostedServer::add_console_text(std::string text)
+    {
+        return console_text_.try_push(std::move(text));
+    }
+
+    void HostedServer::run()
+    {
+        server_number = index_ + 1;
+        line_start = true;
+
+        const auto thread_name = cpputils::format("hlds-{}", server_number);
+        ::pthread_setname_np(::pthread_self(), thread_name.c_str());
+
+        if (std::string cpus{}; cmdline_.find_param("-cpuaffinity", cpus) && (!cpus.empty())) {
+            if (!set_thread_affinity(cpus)) {
+                TextConsole::print("WARNING! -cpuaffinity: Invalid CPU list \"{}\".\n", cpus);
+            }
+        }
+
+        // The filesystem module joins the namespace created for the engine module
+        ::Lmid_t link_map = LM_ID_NEWLM;
+
+        if ((!engine_module_.load(link_map)) || (!filesystem_module_.load(link_map))) {
+            TextConsole::print("Unable to load the server modules into a new namespace: {}\n", ::dlerror());
+            state_.store(HostedServerState::failed, std::memory_order_release);
+            return;
+        }
+
+        auto* const engine_api = engine_module_.get_interface<IDedicatedServerApi>(INTERFACE_DEDICATED_SERVER_API);
+        auto* const filesystem = filesystem_module_.get_interface<IFileSystem>(INTERFACE_FILESYSTEM);
+
+        if ((nullptr == engine_api) || (nullptr == filesystem)) {
+            TextConsole::print("Failed to retrieve the engine and filesystem interfaces.\n");
+            state_.store(HostedServerState::failed, std::memory_order_release);
+            return;
+        }
+
+        filesystem->mount();
+        auto* const launcher_factory = get_factory_this();
+        auto* const filesystem_factory = filesystem_module_.get_factory();
+
+        if (engine_api->init(".", cmdline_.current().c_str(), launcher_factory, filesystem_factory)) {
+            state_.store(HostedServerState::running, std::memory_order_release);
+            run_frames(engine_api);
+            engine_api->shutdown();
+            state_.store(HostedServerState::stopped, std::memory_order_release);
+        }
+        else {
+            TextConsole::print("Failed to initialize engine API.\n");
+            state_.store(HostedServerState::failed, std::memory_order_release);
+        }
+
+        filesystem->unmount();
+    }
+
+    void HostedServer::run_frames(IDedicatedServerApi* const engine_api)
+    {
+        std::string text{};
+        auto running = true;
+        pacer_.configure(frame_rate(cmdline_));
+
+        while (running && (!stopping_.load(std::memory_order_relaxed))) {
+            while (console_text_.try_pop(text)) {
+                text.push_back('\n');
+                engine_api->add_console_text(text.c_str());
+            }
+
+            const auto sleep_start = clock_now();
+            const auto deadline = pacer_.deadline();
+            pacer_.wait();
+
+            const auto frame_start = clock_now();
+            stats_.sleep.record(frame_start - sleep_start);
+            stats_.sleep_overshoot.record(frame_start - deadline);
+
+            running = engine_api->run_frame();
+            stats_.run_frame.record(clock_now() - frame_start);
+        }
+    }
+
+    bool ServerHost::load(const CommandLine& cmdline, const std::string& filename)
+    {
+        std::ifstream file{filename};
+
+        if (!file.good()) {
+            TextConsole::print("WARNING! -hostfile: Unable to open \"{}\".\n", filename);
+            return false;
+        }
+
+        servers_.clear();
+        std::string line{};
+
+        while (std::getline(file, line)) {
+            line = cpputils::trim(line);
+
+            if (line.empty() || ('#' == line.front())) {
+                continue;
+            }
+
+            if (servers_.size() == MAX_HOSTED_SERVERS) {
+                TextConsole::print("WARNING! -hostfile: At most {} servers can be hosted.\n", MAX_HOSTED_SERVERS);
+                break;
+            }
+
+            CommandLine server_cmdline{};
+            server_cmdline.create(cmdline.current() + ' ' + line);
+            server_cmdline.remove_param("-hostfile");
+            servers_.push_back(std::make_unique<HostedServer>(servers_.size(), std::move(server_cmdline)));
+        }
+
+        if (servers_.empty()) {
+            TextConsole::print("WARNING! -hostfile: No servers in \"{}\".\n", filename);
+            return false;
+        }
+
+        return true;
+    }
+
+    void ServerHost::start()
+    {
+        for (const auto& server : servers_) {
+            TextConsole::print("Starting server {}: {}\n", server->index() + 1, server->cmdline().current());
+            server->start();
+        }
+    }
+
+    void ServerHost::run()
+    {
+        std::string text{};
+        auto& console = TextConsole::instance();
+
+        while (active()) {
+            if (console.get_line(text) && (!text.empty()) && (!execute_command(text))) {
+                dispatch(text);
+            }
+
+            std::this_thread::sleep_for(CONSOLE_POLL_INTERVAL);
+        }
+    }
+
+    void ServerHost::stop()
+    {
+        for (const auto& server : servers_) {
+            server->stop();
+        }
+    }
+
+    void ServerHost::dispatch(const std::string& text)
+    {
+        auto command = text;
+        auto target = servers_.size();
+
+        // "@<index> <command>" addresses a single server
+        if ('@' == text.front()) {
+            const auto separator = std::min(text.find_first_of(" \t"), text.size());
+            const auto index = text.substr(1, separator - 1);
+            const auto number = static_cast<std::size_t>(std::strtoul(index.c_str(), nullptr, 10));
+
+            if ((0 == number) || (number > servers_.size())) {
+                TextConsole::print("No server {}.\n", index);
+                return;
+            }
+
+            target = number - 1;
+            command = cpputils::trim(text.substr(separator));
+        }
+
+        for (const auto& server : servers_) {
+            if (((target == servers_.size()) || (target == server->index())) &&
+                (HostedServerState::running == server->state()) && (!server->add_console_text(command))) {
+                TextConsole::print("WARNING! Server {} console queue is full, the command was dropped.\n",
+                  server->index() + 1);
+            }
+        }
+    }
+
+    void ServerHost::print_servers() const
+    {
+        for (const auto& server : servers_) {
+            const auto summary = server->stats().run_frame.summary();
+
+            TextConsole::print("[{}] {}, {} frames, run_frame p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms: {}\n",
+              server->index() + 1, state_name(server->state()), summary.count,
+              to_milliseconds(static_cast<std::int64_t>(summary.p50)),
+              to_milliseconds(static_cast<std::int64_t>(summary.p99)),
+              to_milliseconds(static_cast<std::int64_t>(summary.max)), server->cmdline().current());
+        }
+    }
+
+    bool ServerHost::active() const noexcept
+    {
+        return std::any_of(servers_.cbegin(), servers_.cend(),
+          [](const auto& server)
+          {
+              const auto state = server->state();
+              return (HostedServerState::starting == state) || (HostedServerState::running == state);
+          });
+    }
+
+    bool is_hosted_server_thread() noexcept
+    {
+        return 0 != server_number;
+    }
+
+    std::string tag_hosted_output(const std::string_view text)
+    {
+        const auto tag = cpputils::format("[{}] ", server_number);
+        std::string output{};
+        output.reserve(text.size() + tag.size());
+
+        for (const auto character : text) {
+            if (line_start) {
+                output.append(tag);
+            }
+
+            output.push_back(character);
+            line_start = '\n' == character;
+        }
+
+        return output;
+    }
+
+    void servers_command([[maybe_unused]] const std::string& args)
+    {
+        get_server_host().print_servers();
+    }
+}
@@ -0,0 +1,233 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "command_line.h"
+#include "common/hlds_module.h"
+#include "common/interfaces/dedicated_serverapi.h"
+#include "cpputils/singleton_holder.h"
+#include "cpputils/spsc_queue.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Maximum number of hosted servers. glibc supports 16 link-map namespaces, including the base one.
+     */
+    constexpr std::size_t MAX_HOSTED_SERVERS = 15;
+
+    /**
+     * @brief Life cycle state of a hosted server.
+     */
+    enum class HostedServerState
+    {
+        starting,
+        running,
+        stopped,
+        failed
+    };
+
+    /**
+     * @brief Server instance hosted in the launcher process.
+     *
+     * The server loads its own copies of the engine and filesystem modules into a new \c dlmopen
+     * link-map namespace, and the engine loads the game module into the same namespace, so the
+     * servers share no module data. The frame loop runs on the server thread, paced by its own
+     * frame pacer; the console, the console log and the output writer are shared by all servers.
+     */
+    class HostedServer
+    {
+      public:
+        /**
+         * @brief Constructor.
+         *
+         * @param index Server index, printed in front of the server output.
+         * @param cmdline Server command line.
+         */
+        HostedServer(std::size_t index, CommandLine cmdline);
+
+        HostedServer(HostedServer&&) = delete;
+        HostedServer(const HostedServer&) = delete;
+        HostedServer& operator=(HostedServer&&) = delete;
+        HostedServer& operator=(const HostedServer&) = delete;
+        ~HostedServer();
+
+        /**
+         * @brief Starts the server thread.
+         */
+        void start();
+
+        /**
+         * @brief Asks the server to stop after the current frame and waits for its thread.
+         */
+        void stop();
+
+        /**
+         * @brief Queues a console line for the engine, executed before the next frame.
+         *
+         * @return \c false if the queue is full and the line was dropped.
+         */
+        bool add_console_text(std::string text);
+
+        /**
+         * @brief Returns the server index.
+         */
+        [[nodiscard]] std::size_t index() const noexcept;
+
+        /**
+         * @brief Returns the server command line.
+         */
+        [[nodiscard]] const CommandLine& cmdline() const noexcept;
+
+        /**
+         * @brief Returns the life cycle state of the server.
+         */
+        [[nodiscard]] HostedServerState state() const noexcept;
+
+        /**
+         * @brief Returns the frame loop timings of the server.
+         */
+        [[nodiscard]] const FrameStats& stats() const noexcept;
+
+      private:
+        /* Server index. */
+        std::size_t index_;
+
+        /* Server command line. */
+        CommandLine cmdline_;
+
+        /* Engine module loaded into the server namespace. */
+        common::HldsEngineModule engine_module_{common::ENGINE_MODULE_FILE};
+
+        /* Filesystem module loaded into the server namespace. */
+        common::HldsModule filesystem_module_{common::FILESYSTEM_MODULE_FILE};
+
+        /* Frame loop timings. */
+        FrameStats stats_{};
+
+        /* Frame pacer of the server thread. */
+        FramePacer pacer_{};
+
+        /* Console lines queued by the launcher console for the engine. */
+        cpputils::SpscQueue<std::string, 64> console_text_{};
+
+        /* Life cycle state. */
+        std::atomic<HostedServerState> state_{HostedServerState::starting};
+
+        /* Is the server asked to stop? */
+        std::atomic<bool> stopping_{};
+
+        /* Server thread. */
+        std::thread thread_{};
+
+        /* Server thread entry point. */
+        void run();
+
+        /* Runs the engine frames until the engine quits or the server is stopped. */
+        void run_frames(common::IDedicatedServerApi* engine_api);
+    };
+
+    /**
+     * @brief Hosts several independent servers in the launcher process.
+     *
+     * The main thread serves the shared console: launcher commands are executed by the launcher,
+     * a line in the form <tt>@&lt;index&gt; &lt;command&gt;</tt> is sent to a single server,
+     * any other line is sent to all servers.
+     */
+    class ServerHost
+    {
+      public:
+        /**
+         * @brief Creates a server per line of the specified file. Each line holds the server parameters
+         * that replace or extend the launcher command line; empty lines and lines starting with # are skipped.
+         *
+         * @return \c true if at least one server was created, otherwise \c false
+         */
+        bool load(const CommandLine& cmdline, const std::string& filename);
+
+        /**
+         * @brief Starts the server threads.
+         */
+        void start();
+
+        /**
+         * @brief Serves the console input until all servers have stopped.
+         */
+        void run();
+
+        /**
+         * @brief Stops the servers and waits for their threads.
+         */
+        void stop();
+
+        /**
+         * @brief Sends a console line to the addressed servers.
+         */
+        void dispatch(const std::string& text);
+
+        /**
+         * @brief Prints the state and the frame timings of the servers to the console.
+         */
+        void print_servers() const;
+
+      private:
+        /* Hosted servers. */
+        std::vector<std::unique_ptr<HostedServer>> servers_{};
+
+        /* Returns true if any server is starting or running. */
+        [[nodiscard]] bool active() const noexcept;
+    };
+
+    /**
+     * @brief Returns a server host instance.
+     */
+    [[nodiscard]] inline ServerHost& get_server_host()
+    {
+        return cpputils::SingletonHolder<ServerHost>::get_instance();
+    }
+
+    /**
+     * @brief Returns true if the calling thread is a hosted server thread.
+     */
+    [[nodiscard]] bool is_hosted_server_thread() noexcept;
+
+    /**
+     * @brief Prefixes each line of the text printed by the calling hosted server thread with the server index.
+     */
+    [[nodiscard]] std::string tag_hosted_output(std::string_view text);
+
+    /**
+     * @brief Handler of the \c hlds_servers console command.
+     */
+    void servers_command(const std::string& args);
+
+    inline std::size_t HostedServer::index() const noexcept
+    {
+        return index_;
+    }
+
+    inline const CommandLine& HostedServer::cmdline() const noexcept
+    {
+        return cmdline_;
+    }
+
+    inline HostedServerState HostedServer::state() const noexcept
+    {
+        return state_.load(std::memory_order_acquire);
+    }
+
+    inline const FrameStats& HostedServer::stats() const noexcept
+    {
+        return stats_;
+    }
+}
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include "clock.h"
 #include <chrono>
+#include <cstdint>
 #include <thread>
 
 namespace rehlds::dedicated
@@ -12,6 +14,26 @@ namespace rehlds::dedicated
     using SysSleep = void (*)();
     inline SysSleep sys_sleep = nullptr;
 
+    /**
+     * @brief Requested duration of the fixed-length sleep modes, in nanoseconds.
+     */
+    inline std::int64_t sleep_duration = NANOSECONDS_PER_MILLISECOND;
+
+    /**
+     * @brief Absolute wake-up time requested by the last deadline-driven sleep, or zero.
+     */
+    inline std::int64_t sleep_deadline = 0;
+
+    /**
+     * @brief Can the fixed-length sleep be sized by the next-frame delay reported by the engine?
+     */
+    inline bool sleep_adaptive = false;
+
+    /**
+     * @brief Longest sleep sized by the engine, so the console input is still read while the server idles.
+     */
+    constexpr std::int64_t MAX_ADAPTIVE_SLEEP = 50 * NANOSECONDS_PER_MILLISECOND;
+
     using NetSleep = int (*)();
     inline NetSleep net_sleep = nullptr;
 
@@ -44,6 +66,15 @@ namespace rehlds::dedicated
     {
         std::this_thread::yield();
     }
+
+    /**
+     * @brief Sleeps until the specified time of the monotonic clock, in nanoseconds.
+     */
+    inline void sleep_until(const std::int64_t deadline)
+    {
+        const std::chrono::steady_clock::time_point time{std::chrono::nanoseconds{deadline}};
+        std::this_thread::sleep_until(time);
+    }
 }
 
 #ifdef _WIN32
@@ -62,6 +93,8 @@ namespace rehlds::dedicated
     }
 }
 #else
+  #include "frame_pacer.h"
+  #include "frame_timer.h"
   #include <sys/poll.h>
   #include <sys/time.h>
   #include <csignal>
@@ -122,5 +155,25 @@ namespace rehlds::dedicated
         constexpr std::chrono::microseconds microseconds{3};
         std::this_thread::sleep_for(microseconds);
     }
+
+    /**
+     * @brief -pingboost 6
+     */
+    inline void sleep_pacer()
+    {
+        auto& pacer = get_frame_pacer();
+        sleep_deadline = pacer.deadline();
+        pacer.wait();
+    }
+
+    /**
+     * @brief -pingboost 7
+     */
+    inline void sleep_frame_timer()
+    {
+        auto& timer = get_frame_timer();
+        sleep_deadline = timer.next_expiration();
+        timer.wait();
+    }
 }
 #endif
@@ -0,0 +1,218 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "stall_watchdog.h"
+#include "clock.h"
+#include "console/text_console.h"
+#include "cpputils/format.h"
+#include "realtime.h"
+#include "symbolizer.h"
+#include <execinfo.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+#include <utility>
+
+namespace
+{
+    using rehlds::dedicated::STALL_STACK_FRAMES;
+
+    /* Number of the heartbeat checks per stall threshold. */
+    constexpr std::int64_t CHECKS_PER_THRESHOLD = 4;
+
+    /* Time given to the watched thread to capture its stack. */
+    constexpr std::chrono::milliseconds CAPTURE_TIMEOUT{100};
+
+    /* Frames of the signal handler and of the signal trampoline on top of a captured stack. */
+    constexpr int SKIPPED_FRAMES = 2;
+
+    /* Stack captured by the signal handler. */
+    std::array<void*, STALL_STACK_FRAMES + SKIPPED_FRAMES> captured_frames{};
+
+    /* Depth of the captured stack, negative until the signal handler has run. */
+    std::atomic<int> captured_depth{-1};
+
+    void capture_stack([[maybe_unused]] const int signal_number)
+    {
+        const auto saved_errno = errno;
+        const auto depth = ::backtrace(captured_frames.data(), static_cast<int>(captured_frames.size()));
+        captured_depth.store(depth, std::memory_order_release);
+        errno = saved_errno;
+    }
+
+    /* Signal used to interrupt the watched thread; the real-time signals are not used by the engine. */
+    [[nodiscard]] int capture_signal() noexcept
+    {
+        return SIGRTMIN;
+    }
+
+    [[nodiscard]] std::string local_time()
+    {
+        const auto seconds = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::tm time{};
+        ::localtime_r(&seconds, &time);
+
+        std::array<char, 32> buffer{};
+        const auto length = std::strftime(buffer.data(), buffer.size(), "%Y-%m-%d %H:%M:%S", &time);
+
+        return {buffer.data(), length};
+    }
+}
+
+namespace rehlds::dedicated
+{
+    StallWatchdog::~StallWatchdog()
+    {
+        stop();
+    }
+
+    bool StallWatchdog::start(const std::int64_t threshold, std::string log_path)
+    {
+        stop();
+
+        // The first backtrace loads the unwinder, which must not happen in the signal handler
+        captured_depth.store(::backtrace(captured_frames.data(), 1), std::memory_order_relaxed);
+
+        struct sigaction action{};
+        action.sa_handler = &capture_stack;
+        action.sa_flags = SA_RESTART;
+        ::sigemptyset(&action.sa_mask);
+
+        if (0 != ::sigaction(capture_signal(), &action, nullptr)) {
+            return false;
+        }
+
+        threshold_ = std::max(threshold, NANOSECONDS_PER_MILLISECOND);
+        log_path_ = std::move(log_path);
+        watched_thread_ = ::pthread_self();
+        busy_since_.store(0, std::memory_order_relaxed);
+        stopping_ = false;
+        thread_ = std::thread{&StallWatchdog::run, this};
+
+        return true;
+    }
+
+    void StallWatchdog::stop()
+    {
+        if (!thread_.joinable()) {
+            return;
+        }
+
+        {
+            const std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    void StallWatchdog::record_input(const std::string_view text)
+    {
+        const std::lock_guard lock{input_mutex_};
+        input_[input_count_++ % input_.size()] = text;
+    }
+
+    void StallWatchdog::run()
+    {
+        ::pthread_setname_np(::pthread_self(), "hlds-watchdog");
+        set_background_thread_policy();
+
+        const std::chrono::nanoseconds interval{threshold_ / CHECKS_PER_THRESHOLD};
+        std::int64_t stall_since = 0;
+        std::unique_lock lock{mutex_};
+
+        while (!wake_.wait_for(lock, interval, [this] { return stopping_; })) {
+            const auto since = busy_since_.load(std::memory_order_relaxed);
+            const auto now = clock_now();
+
+            if ((0 != stall_since) && (since != stall_since)) {
+                report_end(stall_since, now);
+                stall_since = 0;
+            }
+
+            if ((0 != since) && (0 == stall_since) && (now - since > threshold_)) {
+                stall_since = since;
+                lock.unlock();
+                report(since, now);
+                lock.lock();
+            }
+        }
+
+        if (0 != stall_since) {
+            report_end(stall_since, clock_now());
+        }
+    }
+
+    void StallWatchdog::report(const std::int64_t since, const std::int64_t now)
+    {
+        stalls_.fetch_add(1, std::memory_order_relaxed);
+        captured_depth.store(-1, std::memory_order_relaxed);
+        auto depth = -1;
+
+        if (0 == ::pthread_kill(watched_thread_, capture_signal())) {
+            const auto deadline = std::chrono::steady_clock::now() + CAPTURE_TIMEOUT;
+
+            while ((depth = captured_depth.load(std::memory_order_acquire)) < 0) {
+                if (std::chrono::steady_clock::now() > deadline) {
+                    break;
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+        }
+
+        cpputils::MemoryBuffer buffer{};
+        cpputils::format_to(buffer, "[{}] Frame stall: the server thread is busy for {:.1f} ms, threshold {:.1f} ms.\n",
+          local_time(), to_milliseconds(now - since), to_milliseconds(threshold_));
+
+        {
+            const std::lock_guard lock{input_mutex_};
+            const auto count = std::min(input_count_, input_.size());
+
+            cpputils::format_to(buffer, "Recent console input:{}\n", 0 == count ? " none" : "");
+
+            for (auto i = input_count_ - count; i < input_count_; ++i) {
+                cpputils::format_to(buffer, "  {}\n", input_[i % input_.size()]);
+            }
+        }
+
+        if (depth <= SKIPPED_FRAMES) {
+            cpputils::format_to(buffer, "Unable to capture the stack of the server thread.\n");
+        }
+        else {
+            cpputils::format_to(buffer, "Stack of the server thread:\n");
+
+            for (auto i = SKIPPED_FRAMES; i < depth; ++i) {
+                const auto* const address = captured_frames[static_cast<std::size_t>(i)];
+                Symbol symbol{};
+                symbolize(address, symbol);
+                cpputils::format_to(buffer, "  #{:<3}{} {:<32} {}\n", i - SKIPPED_FRAMES, address, symbol.module,
+                  symbol.location);
+            }
+        }
+
+        if (auto* const file = std::fopen(log_path_.c_str(), "a"); nullptr != file) {
+            std::fwrite(buffer.data(), 1, buffer.size(), file);
+            std::fclose(file);
+        }
+
+        TextConsole::print("WARNING! Frame stall: the server thread is busy for {:.1f} ms, see \"{}\".\n",
+          to_milliseconds(now - since), log_path_);
+    }
+
+    void StallWatchdog::report_end(const std::int64_t since, const std::int64_t now) const
+    {
+        const auto text = cpputils::format("[{}] Frame stall ended after about {:.1f} ms.\n\n", local_time(),
+          to_milliseconds(now - since));
+
+        if (auto* const file = std::fopen(log_path_.c_str(), "a"); nullptr != file) {
+            std::fwrite(text.data(), 1, text.size(), file);
+            std::fclose(file);
+        }
+    }
+}
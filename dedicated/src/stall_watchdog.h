@@ -0,0 +1,165 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "cpputils/singleton_holder.h"
+#include <pthread.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Maximum number of the captured stack frames.
+     */
+    constexpr std::size_t STALL_STACK_FRAMES = 64;
+
+    /**
+     * @brief Number of the recent console lines written to the stall log.
+     */
+    constexpr std::size_t STALL_CONSOLE_LINES = 8;
+
+    /**
+     * @brief Detects frames of the server loop that run too long and logs where the server thread is stuck.
+     *
+     * The server loop stamps the heartbeat with the time it starts working and clears it before
+     * it goes to sleep; the stamps are relaxed stores of times the loop reads anyway. The watchdog
+     * thread polls the heartbeat a few times per threshold. When the server thread has been busy
+     * for longer than the threshold, the watchdog sends it a signal, whose handler captures the
+     * stack, then writes the symbolized stack, the frame time and the recent console input
+     * to the stall log. A stall is logged once, and its total time is appended when it ends.
+     */
+    class StallWatchdog
+    {
+      public:
+        StallWatchdog() = default;
+        StallWatchdog(StallWatchdog&&) = delete;
+        StallWatchdog(const StallWatchdog&) = delete;
+        StallWatchdog& operator=(StallWatchdog&&) = delete;
+        StallWatchdog& operator=(const StallWatchdog&) = delete;
+        ~StallWatchdog();
+
+        /**
+         * @brief Starts watching the calling thread.
+         *
+         * @param threshold Frame time considered a stall, in nanoseconds.
+         * @param log_path Path of the stall log, the entries are appended.
+         *
+         * @return \c true if the watchdog was started, otherwise \c false
+         */
+        bool start(std::int64_t threshold, std::string log_path);
+
+        /**
+         * @brief Stops the watchdog thread.
+         */
+        void stop();
+
+        /**
+         * @brief Returns true if the watchdog is running.
+         */
+        [[nodiscard]] bool enabled() const noexcept;
+
+        /**
+         * @brief Marks the watched thread busy since the specified time of the monotonic clock.
+         */
+        void busy(std::int64_t since) noexcept;
+
+        /**
+         * @brief Marks the watched thread idle.
+         */
+        void idle() noexcept;
+
+        /**
+         * @brief Remembers a console line for the stall log.
+         */
+        void record_input(std::string_view text);
+
+        /**
+         * @brief Returns the number of the detected stalls.
+         */
+        [[nodiscard]] std::size_t stalls() const noexcept;
+
+      private:
+        /* Frame time considered a stall, in nanoseconds. */
+        std::int64_t threshold_{};
+
+        /* Path of the stall log. */
+        std::string log_path_{};
+
+        /* Watched thread. */
+        ::pthread_t watched_thread_{};
+
+        /* Time the watched thread became busy, zero while it is idle. */
+        std::atomic<std::int64_t> busy_since_{};
+
+        /* Number of the detected stalls. */
+        std::atomic<std::size_t> stalls_{};
+
+        /* Recent console lines, a ring buffer. */
+        std::array<std::string, STALL_CONSOLE_LINES> input_{};
+
+        /* Number of the console lines recorded. */
+        std::size_t input_count_{};
+
+        /* Guards the recent console lines. */
+        std::mutex input_mutex_{};
+
+        /* Wakes the watchdog thread when it is asked to stop. */
+        std::condition_variable wake_{};
+
+        /* Guards the stop request. */
+        std::mutex mutex_{};
+
+        /* Is the watchdog thread asked to stop? */
+        bool stopping_{};
+
+        /* Watchdog thread. */
+        std::thread thread_{};
+
+        /* Thread entry point. */
+        void run();
+
+        /* Captures the stack of the watched thread and writes a stall log entry. */
+        void report(std::int64_t since, std::int64_t now);
+
+        /* Appends the total time of a finished stall to the stall log. */
+        void report_end(std::int64_t since, std::int64_t now) const;
+    };
+
+    /**
+     * @brief Returns a stall watchdog instance.
+     */
+    [[nodiscard]] inline StallWatchdog& get_stall_watchdog()
+    {
+        return cpputils::SingletonHolder<StallWatchdog>::get_instance();
+    }
+
+    inline bool StallWatchdog::enabled() const noexcept
+    {
+        return thread_.joinable();
+    }
+
+    inline void StallWatchdog::busy(const std::int64_t since) noexcept
+    {
+        busy_since_.store(since, std::memory_order_relaxed);
+    }
+
+    inline void StallWatchdog::idle() noexcept
+    {
+        busy_since_.store(0, std::memory_order_relaxed);
+    }
+
+    inline std::size_t StallWatchdog::stalls() const noexcept
+    {
+        return stalls_.load(std::memory_order_relaxed);
+    }
+}
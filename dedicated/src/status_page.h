@@ -0,0 +1,134 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace rehlds::dedicated
+{
+    /* Status page signature, "HLDS". */
+    constexpr std::uint32_t STATUS_PAGE_MAGIC = 0x53444C48;
+
+    /* Status page layout version, incremented on every incompatible change. */
+    constexpr std::uint32_t STATUS_PAGE_VERSION = 2;
+
+    /* Prefix of the shared memory object names. */
+    constexpr auto STATUS_PAGE_PREFIX = "hlds-";
+
+    /**
+     * @brief Server status published in the status page.
+     *
+     * The 64-bit fields come first and the structure is 8-byte aligned, so the layout is identical
+     * for the 32-bit server and 64-bit readers. Times are in nanoseconds.
+     */
+    struct alignas(8) StatusData
+    {
+        /* Wall clock time of the last update and of the process start, since the Unix epoch. */
+        std::int64_t update_time;
+        std::int64_t start_time;
+
+        /* Server frame rate reported by the engine. */
+        double fps;
+
+        /* Frame time statistics. */
+        std::uint64_t frames;
+        std::uint64_t frame_p50;
+        std::uint64_t frame_p99;
+        std::uint64_t frame_p999;
+        std::uint64_t frame_max;
+        std::uint64_t sleep_overshoot_p99;
+        std::uint64_t sleep_overshoot_max;
+
+        /* Process counters, see getrusage(2). */
+        std::int64_t user_time;
+        std::int64_t system_time;
+        std::uint64_t max_resident_kb;
+        std::uint64_t minor_faults;
+        std::uint64_t major_faults;
+        std::uint64_t voluntary_switches;
+        std::uint64_t involuntary_switches;
+
+        /* Console output messages dropped because the output buffer was full. */
+        std::uint64_t output_dropped;
+
+        /* Time spent idle and the estimated server thread CPU time it saved, see -idlesleep. */
+        std::int64_t idle_time;
+        std::int64_t idle_saved_cpu_time;
+
+        std::int32_t pid;
+        std::int32_t active_players;
+        std::int32_t max_players;
+        /* Non-zero while the empty server is idle. */
+        std::int32_t idle;
+
+        /* Current map name, null-terminated. */
+        char map[64];
+    };
+
+    /**
+     * @brief Shared memory status page.
+     *
+     * The data is protected by a sequence lock: the sequence is odd while the server writes the data,
+     * so a reader copies the data and retries if the sequence was odd or has changed meanwhile.
+     */
+    struct alignas(8) StatusPage
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t size;
+        std::atomic<std::uint32_t> sequence;
+        StatusData data;
+    };
+
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+    static_assert(sizeof(StatusData) == 240);
+    static_assert(sizeof(StatusPage) == 256);
+
+    /**
+     * @brief Publishes the data to the status page; single writer.
+     */
+    inline void write_status_page(StatusPage& page, const StatusData& data) noexcept
+    {
+        const auto sequence = page.sequence.load(std::memory_order_relaxed);
+        page.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(&page.data, &data, sizeof(data));
+        page.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies a consistent snapshot of the status page data.
+     *
+     * @return \c false if the page is being written continuously or has an unknown layout.
+     */
+    inline bool read_status_page(const StatusPage& page, StatusData& data) noexcept
+    {
+        constexpr auto max_attempts = 1000;
+
+        if ((STATUS_PAGE_MAGIC != page.magic) || (STATUS_PAGE_VERSION != page.version)) {
+            return false;
+        }
+
+        for (auto attempt = 0; attempt < max_attempts; ++attempt) {
+            const auto sequence = page.sequence.load(std::memory_order_acquire);
+
+            if (0 != (sequence & 1)) {
+                continue;
+            }
+
+            std::memcpy(&data, &page.data, sizeof(data));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (page.sequence.load(std::memory_order_relaxed) == sequence) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
@@ -0,0 +1,146 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "status_publisher.h"
+#include "clock.h"
+#include "console/output_writer.h"
+#include "frame_stats.h"
+#include "idle_governor.h"
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <new>
+#include <unistd.h>
+
+namespace
+{
+    [[nodiscard]] std::int64_t wall_clock_now()
+    {
+        const auto time = std::chrono::system_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    }
+
+    [[nodiscard]] std::int64_t to_nanoseconds(const ::timeval& time)
+    {
+        using namespace rehlds::dedicated;
+        return (time.tv_sec * NANOSECONDS_PER_SECOND) + (time.tv_usec * NANOSECONDS_PER_MICROSECOND);
+    }
+
+    void fill_process_counters(rehlds::dedicated::StatusData& data)
+    {
+        ::rusage usage{};
+
+        if (0 != ::getrusage(RUSAGE_SELF, &usage)) {
+            return;
+        }
+
+        data.user_time = to_nanoseconds(usage.ru_utime);
+        data.system_time = to_nanoseconds(usage.ru_stime);
+        data.max_resident_kb = static_cast<std::uint64_t>(usage.ru_maxrss);
+        data.minor_faults = static_cast<std::uint64_t>(usage.ru_minflt);
+        data.major_faults = static_cast<std::uint64_t>(usage.ru_majflt);
+        data.voluntary_switches = static_cast<std::uint64_t>(usage.ru_nvcsw);
+        data.involuntary_switches = static_cast<std::uint64_t>(usage.ru_nivcsw);
+    }
+}
+
+namespace rehlds::dedicated
+{
+    bool StatusPublisher::open(const std::string& name)
+    {
+        close();
+
+        const auto object_name = '/' + name;
+        constexpr auto mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+        auto descriptor = ::shm_open(object_name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, mode);
+
+        // A page left by a crashed server is replaced; its readers keep the old object until they reopen it
+        if ((descriptor < 0) && (EEXIST == errno) && (0 == ::shm_unlink(object_name.c_str()))) {
+            descriptor = ::shm_open(object_name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, mode);
+        }
+
+        if (descriptor < 0) {
+            return false;
+        }
+
+        void* memory = MAP_FAILED;
+
+        if (0 == ::ftruncate(descriptor, sizeof(StatusPage))) {
+            memory = ::mmap(nullptr, sizeof(StatusPage), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+        }
+
+        ::close(descriptor);
+
+        if (MAP_FAILED == memory) {
+            ::shm_unlink(object_name.c_str());
+            return false;
+        }
+
+        // The header is written last, readers ignore the page until the magic is set
+        page_ = new (memory) StatusPage{};
+        page_->size = sizeof(StatusPage);
+        page_->version = STATUS_PAGE_VERSION;
+        std::atomic_thread_fence(std::memory_order_release);
+        page_->magic = STATUS_PAGE_MAGIC;
+
+        name_ = object_name;
+        start_time_ = wall_clock_now();
+
+        return true;
+    }
+
+    void StatusPublisher::close() noexcept
+    {
+        if (nullptr == page_) {
+            return;
+        }
+
+        ::munmap(page_, sizeof(StatusPage));
+        ::shm_unlink(name_.c_str());
+
+        page_ = nullptr;
+        name_.clear();
+    }
+
+    void StatusPublisher::publish(const ServerStatus& status)
+    {
+        if (nullptr == page_) {
+            return;
+        }
+
+        const auto& stats = get_frame_stats();
+        const auto run_frame = stats.run_frame.summary();
+        const auto sleep_overshoot = stats.sleep_overshoot.summary();
+        const auto& governor = get_idle_governor();
+
+        StatusData data{};
+        data.update_time = wall_clock_now();
+        data.start_time = start_time_;
+        data.fps = status.fps;
+        data.frames = run_frame.count;
+        data.frame_p50 = run_frame.p50;
+        data.frame_p99 = run_frame.p99;
+        data.frame_p999 = run_frame.p999;
+        data.frame_max = run_frame.max;
+        data.sleep_overshoot_p99 = sleep_overshoot.p99;
+        data.sleep_overshoot_max = sleep_overshoot.max;
+        data.output_dropped = get_output_writer().dropped_messages();
+        data.idle_time = governor.stats().idle_time;
+        data.idle_saved_cpu_time = governor.saved_cpu_time();
+        data.pid = static_cast<std::int32_t>(::getpid());
+        data.active_players = status.active_players;
+        data.max_players = status.max_players;
+        data.idle = governor.idle() ? 1 : 0;
+
+        const auto length = std::min(status.map.length(), sizeof(data.map) - 1);
+        std::copy_n(status.map.cbegin(), length, std::begin(data.map));
+
+        fill_process_counters(data);
+        write_status_page(*page_, data);
+    }
+}
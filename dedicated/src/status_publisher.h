@@ -0,0 +1,88 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "cpputils/singleton_holder.h"
+#include "status_page.h"
+#include <string>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Server status reported by the engine.
+     */
+    struct ServerStatus
+    {
+        double fps{};
+        int active_players{};
+        int max_players{};
+        std::string map{};
+    };
+
+    /**
+     * @brief Publishes the server status, frame statistics and process counters in a named
+     * POSIX shared memory object, so external monitoring reads them without querying the server.
+     */
+    class StatusPublisher
+    {
+      public:
+        StatusPublisher() = default;
+        StatusPublisher(StatusPublisher&&) = delete;
+        StatusPublisher(const StatusPublisher&) = delete;
+        StatusPublisher& operator=(StatusPublisher&&) = delete;
+        StatusPublisher& operator=(const StatusPublisher&) = delete;
+        ~StatusPublisher();
+
+        /**
+         * @brief Creates the shared memory object, e.g. \c /dev/shm/hlds-27015 for the name "hlds-27015".
+         *
+         * @return \c true if the status page was created, otherwise \c false
+         */
+        bool open(const std::string& name);
+
+        /**
+         * @brief Unmaps and removes the shared memory object.
+         */
+        void close() noexcept;
+
+        /**
+         * @brief Returns true if the status page is created.
+         */
+        [[nodiscard]] bool is_open() const noexcept;
+
+        /**
+         * @brief Updates the status page.
+         */
+        void publish(const ServerStatus& status);
+
+      private:
+        /* Mapped status page. */
+        StatusPage* page_{};
+
+        /* Shared memory object name. */
+        std::string name_{};
+
+        /* Process start time since the Unix epoch, in nanoseconds. */
+        std::int64_t start_time_{};
+    };
+
+    inline StatusPublisher::~StatusPublisher()
+    {
+        close();
+    }
+
+    inline bool StatusPublisher::is_open() const noexcept
+    {
+        return nullptr != page_;
+    }
+
+    /**
+     * @brief Returns a status publisher instance.
+     */
+    [[nodiscard]] inline StatusPublisher& get_status_publisher()
+    {
+        return cpputils::SingletonHolder<StatusPublisher>::get_instance();
+    }
+}
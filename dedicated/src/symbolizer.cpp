@@ -0,0 +1,41 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "symbolizer.h"
+#include "cpputils/format.h"
+#include <dlfcn.h>
+#include <cstdint>
+
+namespace rehlds::dedicated
+{
+    bool symbolize(const void* const address, Symbol& symbol)
+    {
+        ::Dl_info info{};
+
+        if ((0 == ::dladdr(address, &info)) || (nullptr == info.dli_fname)) {
+            return false;
+        }
+
+        symbol.module = module_file_name(info.dli_fname);
+        const auto value = reinterpret_cast<std::uintptr_t>(address);
+
+        if ((nullptr != info.dli_sname) && (nullptr != info.dli_saddr)) {
+            const auto offset = value - reinterpret_cast<std::uintptr_t>(info.dli_saddr);
+            symbol.function = info.dli_sname;
+            symbol.location = cpputils::format("{}+0x{:x}", symbol.function, offset);
+        }
+        else {
+            const auto offset = value - reinterpret_cast<std::uintptr_t>(info.dli_fbase);
+            symbol.location = cpputils::format("{}+0x{:x}", symbol.module, offset);
+        }
+
+        return true;
+    }
+
+    std::string_view module_file_name(const std::string_view path) noexcept
+    {
+        const auto slash = path.rfind('/');
+        return std::string_view::npos == slash ? path : path.substr(slash + 1);
+    }
+}
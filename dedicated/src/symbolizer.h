@@ -0,0 +1,41 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Code address resolved to its module and nearest exported symbol.
+     */
+    struct Symbol
+    {
+        /* File name of the module containing the address. */
+        std::string module{"unknown"};
+
+        /* Nearest symbol and the offset from it, or the offset from the module base if no symbol is known. */
+        std::string location{"unknown"};
+
+        /* Nearest exported symbol, empty if no symbol is known. */
+        std::string function{};
+    };
+
+    /**
+     * @brief Resolves a code address with \c dladdr.
+     *
+     * Only the dynamic symbol table is searched, so a static function is reported as the offset
+     * from the preceding exported symbol or from the module base; \c addr2line resolves it offline.
+     *
+     * @return \c false if the address is not in a loaded module; the symbol keeps its defaults.
+     */
+    bool symbolize(const void* address, Symbol& symbol);
+
+    /**
+     * @brief Returns the file name part of a module path.
+     */
+    [[nodiscard]] std::string_view module_file_name(std::string_view path) noexcept;
+}
@@ -0,0 +1,432 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "zygote.h"
+#include "console/text_console.h"
+#include "cpputils/string.h"
+#include <link.h>
+#include <poll.h>
+#include <sys/prctl.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+    /* Maximum length of a control request. */
+    constexpr std::size_t MAX_REQUEST_LENGTH = 4096;
+
+    /* Time to wait for a client to send its request. */
+    constexpr ::timeval REQUEST_TIMEOUT{1, 0};
+
+    /* Time given to the instances to exit after SIGTERM, before they are killed. */
+    constexpr std::chrono::seconds TERMINATE_TIMEOUT{10};
+
+    [[nodiscard]] ::sigset_t zygote_signals()
+    {
+        ::sigset_t signals{};
+        ::sigemptyset(&signals);
+        ::sigaddset(&signals, SIGCHLD);
+        ::sigaddset(&signals, SIGTERM);
+        ::sigaddset(&signals, SIGINT);
+
+        return signals;
+    }
+
+    void close_descriptor(int& descriptor) noexcept
+    {
+        if (descriptor >= 0) {
+            ::close(descriptor);
+            descriptor = -1;
+        }
+    }
+
+    [[nodiscard]] std::string read_request(const int client)
+    {
+        std::array<char, MAX_REQUEST_LENGTH> buffer{};
+        std::size_t length = 0;
+
+        while (length < buffer.size()) {
+            const auto result = ::recv(client, buffer.data() + length, buffer.size() - length, 0);
+
+            if ((result < 0) && (EINTR == errno)) {
+                continue;
+            }
+
+            if (result <= 0) {
+                break;
+            }
+
+            const auto* const begin = buffer.data() + length;
+            length += static_cast<std::size_t>(result);
+
+            if (nullptr != std::memchr(begin, '\n', static_cast<std::size_t>(result))) {
+                break;
+            }
+        }
+
+        std::string request{buffer.data(), length};
+
+        if (const auto end = request.find('\n'); std::string::npos != end) {
+            request.resize(end);
+        }
+
+        return cpputils::trim(request);
+    }
+
+    void write_reply(const int client, const std::string& reply)
+    {
+        std::size_t written = 0;
+
+        while (written < reply.size()) {
+            const auto result = ::send(client, reply.data() + written, reply.size() - written, MSG_NOSIGNAL);
+
+            if ((result < 0) && (EINTR == errno)) {
+                continue;
+            }
+
+            if (result <= 0) {
+                break;
+            }
+
+            written += static_cast<std::size_t>(result);
+        }
+    }
+
+    void print_exit_status(const ::pid_t pid, const int status)
+    {
+        using rehlds::dedicated::TextConsole;
+
+        if (WIFEXITED(status)) {
+            TextConsole::print("Zygote: instance {} exited with code {}.\n", pid, WEXITSTATUS(status));
+        }
+        else if (WIFSIGNALED(status)) {
+            TextConsole::print("Zygote: instance {} was terminated by signal {}.\n", pid, WTERMSIG(status));
+        }
+    }
+
+    int warm_segments(::dl_phdr_info* const info, [[maybe_unused]] const std::size_t size, void* const data)
+    {
+        const auto page_size = static_cast<::ElfW(Addr)>(::sysconf(_SC_PAGESIZE));
+        auto& total = *static_cast<std::size_t*>(data);
+
+        for (::ElfW(Half) i = 0; i < info->dlpi_phnum; ++i) {
+            const auto& header = info->dlpi_phdr[i];
+
+            if ((PT_LOAD != header.p_type) || (0 == (header.p_flags & PF_R)) || (0 == header.p_memsz)) {
+                continue;
+            }
+
+            const auto begin = (info->dlpi_addr + header.p_vaddr) & ~(page_size - 1);
+            const auto end = info->dlpi_addr + header.p_vaddr + header.p_memsz;
+
+            // Reading a byte per page maps the page without making a private copy of it
+            for (auto address = begin; address < end; address += page_size) {
+                [[maybe_unused]] const auto value = *reinterpret_cast<const volatile char*>(address);
+            }
+
+            total += end - begin;
+        }
+
+        return 0;
+    }
+}
+
+namespace rehlds::dedicated
+{
+    Zygote::~Zygote()
+    {
+        close();
+    }
+
+    bool Zygote::open(const std::string& socket_path)
+    {
+        close();
+        ::sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+
+        if (socket_path.empty() || (socket_path.size() >= sizeof(address.sun_path))) {
+            TextConsole::print("WARNING! -zygote: Invalid control socket path \"{}\".\n", socket_path);
+            return false;
+        }
+
+        std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size());
+
+        // Replace the socket left by a previous zygote, but never a regular file
+        if (struct ::stat status{}; (0 == ::lstat(socket_path.c_str(), &status)) && S_ISSOCK(status.st_mode)) {
+            ::unlink(socket_path.c_str());
+        }
+
+        socket_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        if (socket_fd_ < 0) {
+            TextConsole::print("WARNING! -zygote: Unable to create the control socket: {}\n", std::strerror(errno));
+            return false;
+        }
+
+        // The control socket is accessible to the owner only
+        const auto mask = ::umask(S_IRWXG | S_IRWXO);
+        const auto bound = 0 == ::bind(socket_fd_, reinterpret_cast<const ::sockaddr*>(&address), sizeof(address));
+        ::umask(mask);
+
+        if ((!bound) || (0 != ::listen(socket_fd_, SOMAXCONN))) {
+            TextConsole::print("WARNING! -zygote: Unable to listen on \"{}\": {}\n", socket_path, std::strerror(errno));
+            close_descriptor(socket_fd_);
+            return false;
+        }
+
+        socket_path_ = socket_path;
+        const auto signals = zygote_signals();
+        ::sigprocmask(SIG_BLOCK, &signals, nullptr);
+        signal_fd_ = ::signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+        if (signal_fd_ < 0) {
+            TextConsole::print("WARNING! -zygote: Unable to create the signal descriptor: {}\n", std::strerror(errno));
+            close();
+            return false;
+        }
+
+        stopping_ = false;
+
+        return true;
+    }
+
+    void Zygote::close() noexcept
+    {
+        if (socket_fd_ < 0) {
+            return;
+        }
+
+        close_descriptor(socket_fd_);
+        close_descriptor(signal_fd_);
+
+        const auto signals = zygote_signals();
+        ::sigprocmask(SIG_UNBLOCK, &signals, nullptr);
+
+        if (!socket_path_.empty()) {
+            ::unlink(socket_path_.c_str());
+            socket_path_.clear();
+        }
+    }
+
+    bool Zygote::serve(const CommandLine& cmdline, CommandLine& instance_cmdline)
+    {
+        TextConsole::print("Zygote: listening on \"{}\".\n", socket_path_);
+
+        while ((!stopping_) && (socket_fd_ >= 0)) {
+            std::array<::pollfd, 2> descriptors{{{socket_fd_, POLLIN, 0}, {signal_fd_, POLLIN, 0}}};
+
+            if (::poll(descriptors.data(), descriptors.size(), -1) < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+
+                TextConsole::print("WARNING! -zygote: poll failed: {}\n", std::strerror(errno));
+                break;
+            }
+
+            if (0 != (descriptors[1].revents & POLLIN)) {
+                handle_signals();
+            }
+
+            if ((!stopping_) && (0 != (descriptors[0].revents & POLLIN))) {
+                accept_request(cmdline, instance_cmdline);
+
+                if (forked_) {
+                    return true;
+                }
+            }
+        }
+
+        terminate_instances();
+        close();
+        TextConsole::print("Zygote: stopped.\n");
+
+        return false;
+    }
+
+    void Zygote::accept_request(const CommandLine& cmdline, CommandLine& instance_cmdline)
+    {
+        const auto client = ::accept4(socket_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+
+        if (client < 0) {
+            return;
+        }
+
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &REQUEST_TIMEOUT, sizeof(REQUEST_TIMEOUT));
+        const auto reply = execute(read_request(client), cmdline, instance_cmdline);
+
+        // The forked child leaves the reply to the zygote
+        if (!forked_) {
+            write_reply(client, reply);
+        }
+
+        ::close(client);
+    }
+
+    std::string Zygote::execute(const std::string& request, const CommandLine& cmdline, CommandLine& instance_cmdline)
+    {
+        const auto separator = request.find_first_of(" \t");
+        const auto command = request.substr(0, separator);
+        const auto argument = std::string::npos == separator ? std::string{} : request.substr(separator);
+
+        if (cpputils::equal_ignore_case(command, "spawn")) {
+            return spawn(argument, cmdline, instance_cmdline);
+        }
+
+        if (cpputils::equal_ignore_case(command, "list")) {
+            std::string reply{};
+
+            for (const auto& [pid, instance] : instances_) {
+                reply.append(cpputils::format("{} {}\n", pid, instance));
+            }
+
+            return reply + cpputils::format("ok {}\n", instances_.size());
+        }
+
+        if (cpputils::equal_ignore_case(command, "kill")) {
+            const auto pid = static_cast<::pid_t>(std::strtol(argument.c_str(), nullptr, 10));
+
+            if (0 == instances_.count(pid)) {
+                return cpputils::format("error no instance {}\n", pid);
+            }
+
+            if (0 != ::kill(pid, SIGTERM)) {
+                return cpputils::format("error {}\n", std::strerror(errno));
+            }
+
+            return "ok\n";
+        }
+
+        if (cpputils::equal_ignore_case(command, "shutdown")) {
+            stopping_ = true;
+            return "ok\n";
+        }
+
+        return cpputils::format("error unknown request \"{}\"\n", command);
+    }
+
+    std::string Zygote::spawn(const std::string& params, const CommandLine& cmdline, CommandLine& instance_cmdline)
+    {
+        CommandLine child_cmdline{};
+        child_cmdline.create(cmdline.current() + ' ' + params);
+        child_cmdline.remove_param("-zygote");
+
+        const auto parent = ::getpid();
+        const auto pid = ::fork();
+
+        if (pid < 0) {
+            return cpputils::format("error {}\n", std::strerror(errno));
+        }
+
+        if (0 == pid) {
+            enter_child();
+
+            // The zygote could exit before the death signal was requested
+            if (::getppid() != parent) {
+                std::_Exit(EXIT_FAILURE);
+            }
+
+            instance_cmdline = std::move(child_cmdline);
+            return {};
+        }
+
+        instances_.emplace(pid, child_cmdline.current());
+        TextConsole::print("Zygote: spawned instance {}: {}\n", pid, child_cmdline.current());
+
+        return cpputils::format("ok {}\n", pid);
+    }
+
+    void Zygote::enter_child()
+    {
+        forked_ = true;
+        instances_.clear();
+
+        // Keep the socket file, it belongs to the zygote
+        socket_path_.clear();
+        close();
+
+        // The instances get the job control signals from the zygote only and exit together with it
+        ::setpgid(0, 0);
+        ::prctl(PR_SET_PDEATHSIG, SIGTERM);
+
+        // A single terminal cannot serve the console input of many instances
+        if (const auto null = ::open("/dev/null", O_RDONLY | O_CLOEXEC); null >= 0) {
+            ::dup2(null, STDIN_FILENO);
+            ::close(null);
+        }
+    }
+
+    void Zygote::handle_signals()
+    {
+        ::signalfd_siginfo info{};
+
+        while (::read(signal_fd_, &info, sizeof(info)) == static_cast<::ssize_t>(sizeof(info))) {
+            if (SIGCHLD == info.ssi_signo) {
+                reap_instances(false);
+            }
+            else {
+                stopping_ = true;
+            }
+        }
+    }
+
+    void Zygote::reap_instances(const bool wait)
+    {
+        int status{};
+        ::pid_t pid{};
+
+        while ((pid = ::waitpid(-1, &status, wait ? 0 : WNOHANG)) > 0) {
+            instances_.erase(pid);
+            print_exit_status(pid, status);
+        }
+    }
+
+    void Zygote::terminate_instances()
+    {
+        if (instances_.empty()) {
+            return;
+        }
+
+        TextConsole::print("Zygote: terminating {} instance(s).\n", instances_.size());
+
+        for (const auto& [pid, instance] : instances_) {
+            ::kill(pid, SIGTERM);
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + TERMINATE_TIMEOUT;
+
+        while ((!instances_.empty()) && (std::chrono::steady_clock::now() < deadline)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{50});
+            reap_instances(false);
+        }
+
+        for (const auto& [pid, instance] : instances_) {
+            TextConsole::print("WARNING! Zygote: instance {} did not exit, killing it.\n", pid);
+            ::kill(pid, SIGKILL);
+        }
+
+        reap_instances(true);
+        instances_.clear();
+    }
+
+    std::size_t warm_module_pages()
+    {
+        std::size_t total = 0;
+        ::dl_iterate_phdr(&warm_segments, &total);
+
+        return total;
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include "command_line.h"
+#include <sys/types.h>
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace rehlds::dedicated
+{
+    /**
+     * @brief Forks server instances from a parent that has already loaded and warmed up the modules.
+     *
+     * The parent listens on a local (\c AF_UNIX) control socket and serves one request per connection:
+     *
+     * - <tt>spawn &lt;params&gt;</tt> forks an instance whose command line is the zygote command line
+     *   with the parameters replaced or appended, replies <tt>ok &lt;pid&gt;</tt>;
+     * - \c list replies a <tt>&lt;pid&gt; &lt;command line&gt;</tt> line per instance and <tt>ok &lt;count&gt;</tt>;
+     * - <tt>kill &lt;pid&gt;</tt> sends \c SIGTERM to an instance;
+     * - \c shutdown terminates the instances and the zygote.
+     *
+     * Instances share the module images copy-on-write. The exited instances are reaped as soon
+     * as \c SIGCHLD arrives.
+     */
+    class Zygote
+    {
+      public:
+        Zygote() = default;
+        Zygote(Zygote&&) = delete;
+        Zygote(const Zygote&) = delete;
+        Zygote& operator=(Zygote&&) = delete;
+        Zygote& operator=(const Zygote&) = delete;
+        ~Zygote();
+
+        /**
+         * @brief Creates the control socket at the specified path, replacing a stale socket file.
+         *
+         * @return \c true if the socket is listening, otherwise \c false
+         */
+        bool open(const std::string& socket_path);
+
+        /**
+         * @brief Closes the control socket and removes the socket file.
+         */
+        void close() noexcept;
+
+        /**
+         * @brief Serves the control requests until \c shutdown, \c SIGTERM or \c SIGINT.
+         *
+         * @param cmdline Zygote command line, the base of the instance command lines.
+         * @param instance_cmdline Receives the instance command line in a forked child.
+         *
+         * @return \c true in a forked child, \c false in the zygote once it has stopped
+         */
+        [[nodiscard]] bool serve(const CommandLine& cmdline, CommandLine& instance_cmdline);
+
+      private:
+        /* Listening control socket. */
+        int socket_fd_{-1};
+
+        /* Signal descriptor receiving SIGCHLD, SIGTERM and SIGINT. */
+        int signal_fd_{-1};
+
+        /* Path of the control socket file. */
+        std::string socket_path_{};
+
+        /* Running instances and their command lines. */
+        std::map<::pid_t, std::string> instances_{};
+
+        /* Set in a forked child. */
+        bool forked_{};
+
+        /* Set when the zygote has to stop. */
+        bool stopping_{};
+
+        /* Accepts a connection and serves its request. */
+        void accept_request(const CommandLine& cmdline, CommandLine& instance_cmdline);
+
+        /* Executes a request and returns the reply. */
+        std::string execute(const std::string& request, const CommandLine& cmdline, CommandLine& instance_cmdline);
+
+        /* Forks an instance. */
+        std::string spawn(const std::string& params, const CommandLine& cmdline, CommandLine& instance_cmdline);
+
+        /* Prepares the forked child to run the instance. */
+        void enter_child();
+
+        /* Handles the signals pending on the signal descriptor. */
+        void handle_signals();
+
+        /* Reaps the exited instances. */
+        void reap_instances(bool wait);
+
+        /* Terminates the running instances and waits for them. */
+        void terminate_instances();
+    };
+
+    /**
+     * @brief Prefaults the pages of the loaded modules, so the forked instances share them.
+     *
+     * @return Number of the prefaulted bytes.
+     */
+    std::size_t warm_module_pages();
+}
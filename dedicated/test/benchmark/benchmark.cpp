@@ -0,0 +1,275 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "../../src/clock.h"
+#include "../../src/command_line.h"
+#include "../../src/dedicated.h"
+#include "../../src/frame_stats.h"
+#include "../stub_engine/stub_engine.h"
+#include "common/hlds_module.h"
+#include "cpputils/format.h"
+#include "cpputils/string.h"
+#include <sys/resource.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#ifndef HLDS_STUB_ENGINE_PATH
+  #error HLDS_STUB_ENGINE_PATH must be defined to the path of the stub engine module.
+#endif
+
+using namespace rehlds::common;
+using namespace rehlds::dedicated;
+using namespace rehlds::dedicated::test;
+
+namespace
+{
+    /* Mode running the default sleep sized by the next-frame delay of the engine. */
+    constexpr std::string_view ADAPTIVE_MODE = "adaptive";
+
+    /**
+     * @brief Benchmark options.
+     */
+    struct Options
+    {
+        /* Frames run by each sleep mode. */
+        std::string frames{"2000"};
+
+        /* Server frame rate. */
+        std::string rate{"1000"};
+
+        /* Simulated frame work, see the stub engine -stubwork parameter. */
+        std::string work{};
+
+        /* Comma-separated list of -pingboost modes, 0 runs the default sleep and "adaptive" the engine-sized sleep. */
+        std::string modes{"0,1,2,3,4,5,6,7,adaptive"};
+
+        /* Remaining benchmark parameters, passed on to the launcher. */
+        CommandLine params{};
+    };
+
+    /**
+     * @brief Pacing accuracy and cost of a sleep mode.
+     */
+    struct Result
+    {
+        std::string mode{};
+        std::size_t frames{};
+        double period{};
+        double mean_interval{};
+        double deviation{};
+        double p50_error{};
+        double p99_error{};
+        double max_error{};
+        double cpu_usage{};
+    };
+
+    [[nodiscard]] std::int64_t cpu_time()
+    {
+        ::rusage usage{};
+        ::getrusage(RUSAGE_SELF, &usage);
+
+        const auto to_nanoseconds = [](const ::timeval& time)
+        {
+            return (time.tv_sec * NANOSECONDS_PER_SECOND) + (time.tv_usec * NANOSECONDS_PER_MICROSECOND);
+        };
+
+        return to_nanoseconds(usage.ru_utime) + to_nanoseconds(usage.ru_stime);
+    }
+
+    [[nodiscard]] double percentile(const std::vector<double>& sorted, const double fraction)
+    {
+        const auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+        return sorted[std::clamp(rank, std::size_t{1}, sorted.size()) - 1];
+    }
+
+    [[nodiscard]] Result evaluate(const std::string& mode, const StubEngineStats& stats)
+    {
+        Result result{};
+        result.mode = mode;
+        result.frames = stats.frames;
+        result.period = to_milliseconds(stats.period);
+
+        if (stats.frames < 2) {
+            return result;
+        }
+
+        std::vector<double> intervals{};
+        std::vector<double> errors{};
+        intervals.reserve(stats.frames - 1);
+        errors.reserve(stats.frames - 1);
+
+        for (std::size_t i = 1; i < stats.frames; ++i) {
+            const auto interval = to_milliseconds(stats.frame_starts[i] - stats.frame_starts[i - 1]);
+            intervals.push_back(interval);
+            errors.push_back(std::abs(interval - result.period));
+        }
+
+        const auto count = static_cast<double>(intervals.size());
+        const auto sum = to_milliseconds(stats.frame_starts[stats.frames - 1] - stats.frame_starts[0]);
+        result.mean_interval = sum / count;
+
+        auto variance = 0.0;
+
+        for (const auto interval : intervals) {
+            variance += (interval - result.mean_interval) * (interval - result.mean_interval);
+        }
+
+        result.deviation = std::sqrt(variance / count);
+
+        std::sort(errors.begin(), errors.end());
+        result.p50_error = percentile(errors, 0.5);
+        result.p99_error = percentile(errors, 0.99);
+        result.max_error = errors.back();
+
+        return result;
+    }
+
+    [[nodiscard]] bool run_mode(const Options& options, const std::string& mode, Result& result)
+    {
+        auto cmdline = options.params;
+        cmdline.set_param("-stubframes", options.frames);
+        cmdline.set_param("+sys_ticrate", options.rate);
+
+        if (!options.work.empty()) {
+            cmdline.set_param("-stubwork", options.work);
+        }
+
+        // The stub engine reports its next-frame delay, which sizes the sleep of the adaptive mode
+        if (ADAPTIVE_MODE == mode) {
+            cmdline.set_param("-adaptivesleep");
+        }
+
+        if (("0" != mode) && (ADAPTIVE_MODE != mode)) {
+            cmdline.set_param("-pingboost", mode);
+        }
+
+        get_frame_stats().reset();
+        const auto cpu_start = cpu_time();
+        const auto wall_start = clock_now();
+
+        if (0 != start_hlds(cmdline)) {
+            return false;
+        }
+
+        const auto wall_time = static_cast<double>(clock_now() - wall_start);
+        const auto cpu_usage = static_cast<double>(cpu_time() - cpu_start) * 100.0 / wall_time;
+        const auto get_stats = get_engine_module().get_proc_address<StubEngineStatsFn>(STUB_ENGINE_STATS_PROC_NAME);
+
+        if (nullptr == get_stats) {
+            return false;
+        }
+
+        result = evaluate(mode, *get_stats());
+        result.cpu_usage = cpu_usage;
+
+        return true;
+    }
+
+    /* Creates a working directory where the stub poses as the engine and filesystem modules. */
+    [[nodiscard]] bool prepare_directory(const std::filesystem::path& directory)
+    {
+        std::error_code error{};
+        std::filesystem::create_directories(directory, error);
+
+        for (const auto* const name : {ENGINE_MODULE_FILE, FILESYSTEM_MODULE_FILE}) {
+            const auto link = directory / name;
+            std::filesystem::remove(link, error);
+            std::filesystem::create_symlink(HLDS_STUB_ENGINE_PATH, link, error);
+
+            if (error) {
+                cpputils::print(stderr, "Unable to create {}: {}\n", link.string(), error.message());
+                return false;
+            }
+        }
+
+        std::filesystem::current_path(directory, error);
+
+        return !error;
+    }
+
+    [[nodiscard]] Options parse_options(const int argc, const char* const* argv)
+    {
+        Options options{};
+        auto& cmdline = options.params;
+        cmdline.create(argc, argv);
+
+        const std::array<std::pair<const char*, std::string*>, 4> values{
+          {{"-frames", &options.frames}, {"-rate", &options.rate}, {"-work", &options.work}, {"-modes", &options.modes}}
+        };
+
+        for (const auto& [name, value] : values) {
+            if (std::string text{}; cmdline.find_param(name, text) && (!text.empty())) {
+                *value = std::move(text);
+            }
+
+            cmdline.remove_param(name);
+        }
+
+        return options;
+    }
+
+    void print_results(const Options& options, const std::vector<Result>& results)
+    {
+        cpputils::print("\nFrame rate {}, work \"{}\", {} frames per mode. Times in milliseconds.\n", options.rate,
+          options.work.empty() ? "none" : options.work, options.frames);
+
+        cpputils::print("{:<10}{:>8}{:>10}{:>10}{:>10}{:>10}{:>10}{:>10}{:>8}\n", "pingboost", "frames", "target",
+          "mean", "stddev", "p50 err", "p99 err", "max err", "cpu %");
+
+        for (const auto& result : results) {
+            cpputils::print("{:<10}{:>8}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}{:>8.1f}\n",
+              "0" == result.mode ? "default" : result.mode, result.frames, result.period, result.mean_interval,
+              result.deviation, result.p50_error, result.p99_error, result.max_error, result.cpu_usage);
+        }
+    }
+}
+
+/**
+ * @brief Runs the launcher against the stub engine with each sleep mode and reports the frame pacing.
+ *
+ * Usage: hlds_benchmark [-frames N] [-rate FPS] [-work SPEC] [-modes 0,1,...,adaptive] [launcher parameters]
+ */
+int main(const int argc, const char* const argv[])
+{
+    const auto options = parse_options(argc, argv);
+    const auto directory = std::filesystem::temp_directory_path() / cpputils::format("hlds-benchmark-{}", ::getpid());
+
+    if (!prepare_directory(directory)) {
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Result> results{};
+    auto exit_code = EXIT_SUCCESS;
+
+    const auto modes = cpputils::split(options.modes, ",", cpputils::StringSplitOptions::trim_remove_empty_entries);
+
+    for (const auto& mode : modes) {
+        Result result{};
+
+        if (run_mode(options, mode, result)) {
+            results.push_back(result);
+        }
+        else {
+            cpputils::print(stderr, "-pingboost {}: the launcher failed to run the stub engine.\n", mode);
+            exit_code = EXIT_FAILURE;
+        }
+    }
+
+    print_results(options, results);
+
+    std::error_code error{};
+    std::filesystem::current_path(std::filesystem::temp_directory_path(), error);
+    std::filesystem::remove_all(directory, error);
+
+    return exit_code;
+}
@@ -0,0 +1,18 @@
+# Checks that the executable exports the symbols in its dynamic symbol table.
+# Usage: cmake -DNM=<nm> -DFILE=<executable> -DSYMBOLS=<name;...> -P check_exports.cmake
+
+execute_process(
+  COMMAND "${NM}" -D --defined-only "${FILE}"
+  OUTPUT_VARIABLE exports
+  RESULT_VARIABLE result
+)
+
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Unable to read the dynamic symbol table of ${FILE}.")
+endif()
+
+foreach(symbol IN LISTS SYMBOLS)
+  if(NOT exports MATCHES " [TW] ${symbol}\n")
+    message(SEND_ERROR "${symbol} is not exported by ${FILE}.")
+  endif()
+endforeach()
@@ -0,0 +1,586 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "stub_engine.h"
+#include "../../src/clock.h"
+#include "common/interface.h"
+#include "common/interfaces/dedicated_serverapi.h"
+#include "common/interfaces/filesystem.h"
+#include "common/platform.h"
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+using namespace rehlds::common;
+using namespace rehlds::dedicated;
+using namespace rehlds::dedicated::test;
+
+namespace
+{
+    /* Number of frames run when -stubframes is not specified. */
+    constexpr std::size_t DEFAULT_FRAMES = 1000;
+
+    /* Frame rate used when +sys_ticrate is not specified. */
+    constexpr auto DEFAULT_RATE = 1000.0;
+
+    /**
+     * @brief Simulated frame work, selected with -stubwork.
+     */
+    enum class WorkType
+    {
+        none,   /* No work. */
+        busy,   /* "busy:<iterations>", a fixed number of arithmetic iterations. */
+        fixed,  /* "fixed:<microseconds>", spins for a fixed duration. */
+        random, /* "random:<mean>:<deviation>", spins for a normally distributed duration in microseconds. */
+    };
+
+    /* Returns the value of the specified parameter of the engine command line. */
+    [[nodiscard]] std::string find_param(const std::string_view cmdline, const std::string_view name)
+    {
+        std::string::size_type position = 0;
+
+        while ((position = cmdline.find(name, position)) != std::string_view::npos) {
+            const auto end = position + name.size();
+
+            const auto starts_word = (0 == position) || (' ' == cmdline[position - 1]);
+            const auto ends_word = (end == cmdline.size()) || (' ' == cmdline[end]);
+
+            if (starts_word && ends_word) {
+                const auto value_start = cmdline.find_first_not_of(' ', end);
+
+                if ((std::string_view::npos == value_start) || ('-' == cmdline[value_start]) ||
+                    ('+' == cmdline[value_start])) {
+                    return {};
+                }
+
+                const auto value_end = std::min(cmdline.find(' ', value_start), cmdline.size());
+                return std::string{cmdline.substr(value_start, value_end - value_start)};
+            }
+
+            position = end;
+        }
+
+        return {};
+    }
+
+    class StubEngine final : public IDedicatedServerApiEx
+    {
+      public:
+        bool init(const char* basedir, const char* cmdline, CreateInterfaceFn launcher_factory,
+          CreateInterfaceFn filesystem_factory) override;
+
+        int shutdown() override;
+        bool run_frame() override;
+        void add_console_text(const char* text) override;
+        void update_status(float* fps, int* active_players, int* max_players, char* current_map) override;
+        void get_frame_state(EngineFrameState* state) override;
+
+        /* Sleeps until the next frame is due, emulating the engine socket wait. */
+        void net_sleep() const;
+
+        [[nodiscard]] const StubEngineStats& stats() const noexcept;
+
+      private:
+        std::size_t max_frames_{DEFAULT_FRAMES};
+        std::int64_t period_{};
+        WorkType work_type_{WorkType::none};
+        double work_mean_{};
+        double work_deviation_{};
+        bool quit_{};
+        int socket_{-1};
+        std::mt19937 random_{};
+        std::vector<std::int64_t> frame_starts_{};
+        StubEngineStats stats_{};
+
+        /* Parses the -stubwork specification. */
+        void configure_work(const std::string& work);
+
+        /* Runs the simulated frame work. */
+        void do_work();
+
+        /* Opens the UDP socket on the -stubport port of the loopback address, as the engine does on its port. */
+        void open_socket(const std::string& port);
+
+        /* Reads the datagrams received on the socket. */
+        void read_socket() const;
+
+        /* Returns the time the next frame is due on the monotonic clock. */
+        [[nodiscard]] std::int64_t next_frame_deadline() const;
+    };
+
+    StubEngine stub_engine{};
+
+    bool StubEngine::init(const char* const /* basedir */, const char* const cmdline,
+      const CreateInterfaceFn /* launcher_factory */, const CreateInterfaceFn /* filesystem_factory */)
+    {
+        const std::string_view params{nullptr == cmdline ? "" : cmdline};
+
+        if (const auto frames = find_param(params, "-stubframes"); !frames.empty()) {
+            const auto count = static_cast<std::size_t>(std::strtoul(frames.c_str(), nullptr, 10));
+            max_frames_ = std::max(count, std::size_t{1});
+        }
+
+        auto rate = DEFAULT_RATE;
+
+        if (const auto tic_rate = find_param(params, "+sys_ticrate"); !tic_rate.empty()) {
+            rate = std::max(std::strtod(tic_rate.c_str(), nullptr), 1.0);
+        }
+
+        period_ = static_cast<std::int64_t>(static_cast<double>(NANOSECONDS_PER_SECOND) / rate);
+        configure_work(find_param(params, "-stubwork"));
+        open_socket(find_param(params, "-stubport"));
+
+        quit_ = false;
+        random_.seed(1);
+        frame_starts_.clear();
+        frame_starts_.reserve(max_frames_);
+        stats_ = {};
+        stats_.period = period_;
+
+        return true;
+    }
+
+    int StubEngine::shutdown()
+    {
+        stats_.frames = frame_starts_.size();
+        stats_.frame_starts = frame_starts_.data();
+
+        if (socket_ >= 0) {
+            ::close(socket_);
+            socket_ = -1;
+        }
+
+        return 0;
+    }
+
+    bool StubEngine::run_frame()
+    {
+        const auto frame_start = clock_now();
+        frame_starts_.push_back(frame_start);
+
+        read_socket();
+        do_work();
+        stats_.work_time += clock_now() - frame_start;
+
+        return (!quit_) && (frame_starts_.size() < max_frames_);
+    }
+
+    void StubEngine::add_console_text(const char* const text)
+    {
+        if ((nullptr != text) && (0 == std::strncmp(text, "quit", 4))) {
+            quit_ = true;
+        }
+    }
+
+    void StubEngine::update_status(
+      float* const fps, int* const active_players, int* const max_players, char* const current_map)
+    {
+        *fps = static_cast<float>(static_cast<double>(NANOSECONDS_PER_SECOND) / static_cast<double>(period_));
+        *active_players = 0;
+        *max_players = 32;
+        std::strcpy(current_map, "stub");
+    }
+
+    void StubEngine::get_frame_state(EngineFrameState* const state)
+    {
+        state->next_frame_delay = next_frame_deadline() - clock_now();
+        state->network_pending = 0;
+    }
+
+    void StubEngine::net_sleep() const
+    {
+        const auto deadline = next_frame_deadline();
+        const auto time = to_timespec(deadline);
+
+        while (EINTR == ::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, nullptr)) {
+        }
+    }
+
+    const StubEngineStats& StubEngine::stats() const noexcept
+    {
+        return stats_;
+    }
+
+    std::int64_t StubEngine::next_frame_deadline() const
+    {
+        return frame_starts_.empty() ? clock_now() + period_ : frame_starts_.back() + period_;
+    }
+
+    void StubEngine::configure_work(const std::string& work)
+    {
+        work_type_ = WorkType::none;
+
+        const auto first = work.find(':');
+        const auto type = work.substr(0, first);
+        const auto values = std::string::npos == first ? std::string{} : work.substr(first + 1);
+        const auto second = values.find(':');
+
+        const auto mean = values.substr(0, second);
+        const auto deviation = std::string::npos == second ? std::string{} : values.substr(second + 1);
+        work_mean_ = std::strtod(mean.c_str(), nullptr);
+        work_deviation_ = std::strtod(deviation.c_str(), nullptr);
+
+        if ("busy" == type) {
+            work_type_ = WorkType::busy;
+        }
+        else if ("fixed" == type) {
+            work_type_ = WorkType::fixed;
+        }
+        else if ("random" == type) {
+            work_type_ = WorkType::random;
+        }
+    }
+
+    void StubEngine::open_socket(const std::string& port)
+    {
+        if (port.empty() || (socket_ >= 0)) {
+            return;
+        }
+
+        socket_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+        ::sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<std::uint16_t>(std::strtoul(port.c_str(), nullptr, 10)));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if ((socket_ >= 0) &&
+            (0 != ::bind(socket_, reinterpret_cast<const ::sockaddr*>(&address), sizeof(address)))) {
+            ::close(socket_);
+            socket_ = -1;
+        }
+    }
+
+    void StubEngine::read_socket() const
+    {
+        std::array<char, 1400> packet{};
+
+        while ((socket_ >= 0) && (::recv(socket_, packet.data(), packet.size(), 0) >= 0)) {
+        }
+    }
+
+    void StubEngine::do_work()
+    {
+        auto duration = 0.0;
+
+        switch (work_type_) {
+            case WorkType::none:
+                return;
+
+            case WorkType::busy: {
+                volatile std::uint64_t value = 0;
+
+                for (auto i = static_cast<std::uint64_t>(work_mean_); i > 0; --i) {
+                    value = value * 31 + i;
+                }
+
+                return;
+            }
+
+            case WorkType::fixed:
+                duration = work_mean_;
+                break;
+
+            case WorkType::random:
+                duration = std::normal_distribution<>{work_mean_, work_deviation_}(random_);
+                break;
+        }
+
+        const auto deadline = clock_now() + static_cast<std::int64_t>(std::max(duration, 0.0) * 1000.0);
+
+        while (clock_now() < deadline) {
+        }
+    }
+
+    class StubFileSystem final : public IFileSystem
+    {
+      public:
+        void mount() override
+        {
+        }
+
+        void unmount() override
+        {
+        }
+
+        void remove_all_search_paths() override
+        {
+        }
+
+        void add_search_path(const char* /* path */, const char* /* path_id */) override
+        {
+        }
+
+        bool remove_search_path(const char* /* path */) override
+        {
+            return false;
+        }
+
+        void remove_file(const char* /* relative_path */, const char* /* path_id */) override
+        {
+        }
+
+        void create_dir_hierarchy(const char* /* path */, const char* /* path_id */) override
+        {
+        }
+
+        bool file_exists(const char* /* filename */) override
+        {
+            return false;
+        }
+
+        bool is_directory(const char* /* filename */) override
+        {
+            return false;
+        }
+
+        FileHandle open(const char* /* filename */, const char* /* options */, const char* /* path_id */) override
+        {
+            return FILESYSTEM_INVALID_HANDLE;
+        }
+
+        void close(FileHandle /* file */) override
+        {
+        }
+
+        void seek(FileHandle /* file */, int /* position */, FileSystemSeek /* type */) override
+        {
+        }
+
+        unsigned int tell(FileHandle /* file */) override
+        {
+            return 0;
+        }
+
+        unsigned int size(FileHandle /* file */) override
+        {
+            return 0;
+        }
+
+        unsigned int size(const char* /* filename */) override
+        {
+            return 0;
+        }
+
+        long get_filetime(const char* /* filename */) override
+        {
+            return 0;
+        }
+
+        void filetime_to_string(char* const strip, const int max_chars, long /* filetime */) override
+        {
+            if ((nullptr != strip) && (max_chars > 0)) {
+                *strip = '\0';
+            }
+        }
+
+        bool is_ok(FileHandle /* file */) override
+        {
+            return false;
+        }
+
+        void flush(FileHandle /* file */) override
+        {
+        }
+
+        bool end_of_file(FileHandle /* file */) override
+        {
+            return true;
+        }
+
+        int read(void* /* output */, int /* size */, FileHandle /* file */) override
+        {
+            return 0;
+        }
+
+        int write(const void* /* input */, int /* size */, FileHandle /* file */) override
+        {
+            return 0;
+        }
+
+        char* read_line(char* /* output */, int /* max_chars */, FileHandle /* file */) override
+        {
+            return nullptr;
+        }
+
+        int print(FileHandle /* file */, char* /* format */, ...) override
+        {
+            return 0;
+        }
+
+        void* get_read_buffer(FileHandle /* file */, int* /* out_buffer_size */, bool /* fail_if_not_cached */) override
+        {
+            return nullptr;
+        }
+
+        void release_read_buffer(FileHandle /* file */, void* /* read_buffer */) override
+        {
+        }
+
+        const char* find_first(const char* /* wild_card */, FileFindHandle* handle, const char* /* path_id */) override
+        {
+            if (nullptr != handle) {
+                *handle = FILESYSTEM_INVALID_FIND_HANDLE;
+            }
+
+            return nullptr;
+        }
+
+        const char* find_next(FileFindHandle /* handle */) override
+        {
+            return nullptr;
+        }
+
+        bool find_is_directory(FileFindHandle /* handle */) override
+        {
+            return false;
+        }
+
+        void find_close(FileFindHandle /* handle */) override
+        {
+        }
+
+        void get_local_copy(const char* /* filename */) override
+        {
+        }
+
+        const char* get_local_path(const char* /* filename */, char* /* local_path */, int /* size */) override
+        {
+            return nullptr;
+        }
+
+        char* parse_file(char* /* file_bytes */, char* /* token */, bool* /* was_quoted */) override
+        {
+            return nullptr;
+        }
+
+        bool full_path_to_relative_path(const char* /* full_path */, char* /* relative */) override
+        {
+            return false;
+        }
+
+        bool get_current_directory(char* /* directory */, int /* max_length */) override
+        {
+            return false;
+        }
+
+        void print_opened_files() override
+        {
+        }
+
+        void set_warning_func(WarningFn /* warning_func */) override
+        {
+        }
+
+        void set_warning_level(FileWarningLevel /* level */) override
+        {
+        }
+
+        void log_level_load_started(const char* /* name */) override
+        {
+        }
+
+        void log_level_load_finished(const char* /* name */) override
+        {
+        }
+
+        int hint_resource_need(const char* /* hint_list */, int /* forget_everything */) override
+        {
+            return 0;
+        }
+
+        int pause_resource_preloading() override
+        {
+            return 0;
+        }
+
+        int resume_resource_preloading() override
+        {
+            return 0;
+        }
+
+        int set_buffer(FileHandle /* stream */, char* /* buffer */, int /* mode */, long /* size */) override
+        {
+            return 0;
+        }
+
+        void get_interface_version(char* const buffer, const int max_length) override
+        {
+            if ((nullptr != buffer) && (max_length > 0)) {
+                std::strncpy(buffer, INTERFACE_FILESYSTEM, static_cast<std::size_t>(max_length) - 1);
+                buffer[max_length - 1] = '\0';
+            }
+        }
+
+        bool is_file_immediately_available(const char* /* filename */) override
+        {
+            return false;
+        }
+
+        WaitForResourcesHandle wait_for_resources(const char* /* resource_list */) override
+        {
+            return 0;
+        }
+
+        bool get_wait_for_resources_progress(
+          WaitForResourcesHandle /* handle */, float* const progress, bool* const complete) override
+        {
+            *progress = 0.F;
+            *complete = true;
+
+            return false;
+        }
+
+        void cancel_wait_for_resources(WaitForResourcesHandle /* handle */) override
+        {
+        }
+
+        bool is_app_ready_for_offline_play(int /* app_id */) override
+        {
+            return true;
+        }
+
+        bool add_pack_file(const char* /* full_path */, const char* /* path_id */) override
+        {
+            return false;
+        }
+
+        FileHandle open_from_cache_for_read(
+          const char* /* filename */, const char* /* options */, const char* /* path_id */) override
+        {
+            return FILESYSTEM_INVALID_HANDLE;
+        }
+
+        void add_search_path_no_write(const char* /* path */, const char* /* path_id */) override
+        {
+        }
+    };
+}
+
+EXPOSE_SINGLE_INTERFACE_GLOBALVAR(StubEngine, IDedicatedServerApi, INTERFACE_DEDICATED_SERVER_API, stub_engine)
+EXPOSE_SINGLE_INTERFACE_GLOBALVAR(StubEngine, IDedicatedServerApiEx, INTERFACE_DEDICATED_SERVER_API_EX, stub_engine)
+EXPOSE_SINGLE_INTERFACE(StubFileSystem, IFileSystem, INTERFACE_FILESYSTEM)
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+extern "C" DLL_EXPORT int NET_Sleep_Timeout()
+{
+    stub_engine.net_sleep();
+    return 0;
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+extern "C" DLL_EXPORT const StubEngineStats* StubEngine_GetStats()
+{
+    return &stub_engine.stats();
+}
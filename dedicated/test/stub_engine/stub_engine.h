@@ -0,0 +1,39 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rehlds::dedicated::test
+{
+    /**
+     * @brief Name of the function that returns the statistics of the last stub engine run.
+     */
+    constexpr auto* STUB_ENGINE_STATS_PROC_NAME = "StubEngine_GetStats";
+
+    /**
+     * @brief Frame timings recorded by the stub engine between \c init() and \c shutdown().
+     */
+    struct StubEngineStats
+    {
+        /* Frame period requested with +sys_ticrate, in nanoseconds. */
+        std::int64_t period{};
+
+        /* Number of the run frames. */
+        std::size_t frames{};
+
+        /* Start time of every frame on the monotonic clock, in nanoseconds. */
+        const std::int64_t* frame_starts{};
+
+        /* Total time spent in the simulated frame work, in nanoseconds. */
+        std::int64_t work_time{};
+    };
+
+    /**
+     * @brief Returns the statistics of the last stub engine run; valid until the next \c init().
+     */
+    using StubEngineStatsFn = const StubEngineStats* (*)();
+}
@@ -0,0 +1,59 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "../src/console/completion_index.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace rehlds::dedicated::test
+{
+    TEST(CompletionIndex, Empty)
+    {
+        const CompletionIndex index{};
+        ASSERT_TRUE(index.needs_rebuild(false));
+        ASSERT_TRUE(index.find("sv").names.empty());
+        ASSERT_EQ(0, index.size());
+    }
+
+    TEST(CompletionIndex, FindPrefix)
+    {
+        CompletionIndex index{};
+        index.rebuild({"sv_gravity", "SV_Cheats", "map", "sv_maxspeed", "maps", "sv_cheats"});
+        ASSERT_FALSE(index.needs_rebuild(false));
+        ASSERT_EQ(5, index.size());
+
+        auto matches = index.find("SV_");
+        ASSERT_EQ((std::vector<std::string>{"sv_cheats", "sv_gravity", "sv_maxspeed"}), matches.names);
+        ASSERT_EQ("sv_", matches.common_prefix);
+        ASSERT_EQ(11, matches.longest_length);
+
+        matches = index.find("ma");
+        ASSERT_EQ((std::vector<std::string>{"map", "maps"}), matches.names);
+        ASSERT_EQ("map", matches.common_prefix);
+
+        matches = index.find("maps");
+        ASSERT_EQ(1, matches.names.size());
+        ASSERT_EQ("maps", matches.common_prefix);
+
+        ASSERT_TRUE(index.find("quit").names.empty());
+        ASSERT_TRUE(index.find("svx").names.empty());
+    }
+
+    TEST(CompletionIndex, Invalidate)
+    {
+        CompletionIndex index{};
+        index.rebuild({"status"});
+        ASSERT_FALSE(index.needs_rebuild(false));
+
+        // A miss right after a rebuild does not trigger another one
+        ASSERT_FALSE(index.needs_rebuild(true));
+
+        index.invalidate();
+        ASSERT_TRUE(index.needs_rebuild(false));
+
+        index.rebuild({"status"}, false);
+        ASSERT_TRUE(index.needs_rebuild(false));
+    }
+}
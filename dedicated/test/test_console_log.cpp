@@ -0,0 +1,92 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "../src/console/console_log.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace rehlds::dedicated::test
+{
+    namespace
+    {
+        /* Returns an empty directory for the log files. */
+        [[nodiscard]] std::filesystem::path log_directory(const std::string& name)
+        {
+            auto directory = std::filesystem::temp_directory_path() / name;
+            std::filesystem::remove_all(directory);
+
+            return directory;
+        }
+
+        /* Returns the text of all files of the directory. */
+        [[nodiscard]] std::string read_all(const std::filesystem::path& directory)
+        {
+            std::string text{};
+
+            for (const auto& entry : std::filesystem::directory_iterator{directory}) {
+                std::ifstream file{entry.path(), std::ios_base::binary};
+                text.append(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+            }
+
+            return text;
+        }
+    }
+
+    TEST(ConsoleLog, WritesWhileOpen)
+    {
+        const auto directory = log_directory("hlds_console_log_writes");
+        ConsoleLog log{};
+        log.write("discarded\n");
+
+        ConsoleLogOptions options{};
+        options.path = directory / "console.log";
+        ASSERT_TRUE(log.open(options));
+        ASSERT_TRUE(log.is_open());
+
+        log.write("first line\n");
+        log.write("second line\n");
+        log.close();
+        ASSERT_FALSE(log.is_open());
+
+        log.write("discarded\n");
+        ASSERT_EQ("first line\nsecond line\n", read_all(directory));
+        std::filesystem::remove_all(directory);
+    }
+
+    TEST(ConsoleLog, RotatesBySize)
+    {
+        const auto directory = log_directory("hlds_console_log_rotates");
+        ConsoleLog log{};
+
+        ConsoleLogOptions options{};
+        options.path = directory / "console.log";
+        options.max_size = 64;
+        options.buffer_size = 64;
+        ASSERT_TRUE(log.open(options));
+
+        const std::string line(40, 'x');
+
+        for (auto i = 0; i < 4; ++i) {
+            log.close();
+            ASSERT_TRUE(log.open(options));
+            log.write(line + '\n');
+        }
+
+        log.close();
+
+        std::size_t files = 0;
+
+        for (const auto& entry : std::filesystem::directory_iterator{directory}) {
+            ASSERT_LE(entry.file_size(), options.max_size);
+            ++files;
+        }
+
+        ASSERT_EQ(4, files);
+        ASSERT_EQ(4 * (line.length() + 1), read_all(directory).length());
+        std::filesystem::remove_all(directory);
+    }
+}
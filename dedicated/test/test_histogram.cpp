@@ -0,0 +1,77 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "../src/histogram.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+
+namespace rehlds::dedicated::test
+{
+    TEST(Histogram, BucketIndexIsMonotonic)
+    {
+        std::size_t previous = 0;
+
+        for (std::uint64_t value = 0; value <= UINT32_MAX; value = value * 3 / 2 + 1) {
+            const auto index = Histogram::bucket_index(static_cast<std::uint32_t>(value));
+            ASSERT_LT(index, Histogram::BUCKET_COUNT);
+            ASSERT_GE(index, previous);
+            ASSERT_GE(Histogram::bucket_upper_bound(index), value);
+            previous = index;
+        }
+
+        ASSERT_EQ(Histogram::BUCKET_COUNT - 1, Histogram::bucket_index(UINT32_MAX));
+        ASSERT_EQ(UINT32_MAX, Histogram::bucket_upper_bound(Histogram::BUCKET_COUNT - 1));
+    }
+
+    TEST(Histogram, BucketRelativeError)
+    {
+        for (std::uint32_t value = 1; value < 100'000'000; value = value * 5 / 4 + 1) {
+            const auto upper_bound = Histogram::bucket_upper_bound(Histogram::bucket_index(value));
+            ASSERT_LE(static_cast<double>(upper_bound - value) / static_cast<double>(value), 1.0 / 32.0);
+        }
+    }
+
+    TEST(Histogram, Empty)
+    {
+        const Histogram histogram{};
+        const auto summary = histogram.summary();
+        ASSERT_EQ(0, summary.count);
+        ASSERT_EQ(0, summary.p50);
+        ASSERT_EQ(0, summary.max);
+    }
+
+    TEST(Histogram, Percentiles)
+    {
+        Histogram histogram{};
+
+        for (std::int64_t i = 1; i <= 10'000; ++i) {
+            histogram.record(i * 1'000);
+        }
+
+        const auto summary = histogram.summary();
+        ASSERT_EQ(10'000, summary.count);
+        ASSERT_EQ(10'000'000, summary.max);
+        ASSERT_NEAR(5'000'000, summary.p50, 5'000'000 / 32);
+        ASSERT_NEAR(9'900'000, summary.p99, 9'900'000 / 32);
+        ASSERT_NEAR(9'990'000, summary.p999, 9'990'000 / 32);
+        ASSERT_LE(summary.p999, summary.max);
+    }
+
+    TEST(Histogram, ClampAndReset)
+    {
+        Histogram histogram{};
+        histogram.record(-5);
+        histogram.record(INT64_MAX);
+
+        auto summary = histogram.summary();
+        ASSERT_EQ(2, summary.count);
+        ASSERT_EQ(UINT32_MAX, summary.max);
+        ASSERT_EQ(0, summary.p50);
+
+        histogram.reset();
+        summary = histogram.summary();
+        ASSERT_EQ(0, summary.count);
+        ASSERT_EQ(0, histogram.count());
+    }
+}
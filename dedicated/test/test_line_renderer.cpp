@@ -0,0 +1,53 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "../src/console/line_renderer.h"
+#include <gtest/gtest.h>
+
+namespace rehlds::dedicated::test
+{
+    TEST(LineRenderer, AppendCharacters)
+    {
+        LineRenderer renderer{};
+        ASSERT_EQ("m", renderer.update("m", 1));
+        ASSERT_EQ("ap", renderer.update("map", 3));
+        ASSERT_EQ("", renderer.update("map", 3));
+    }
+
+    TEST(LineRenderer, CursorMovement)
+    {
+        LineRenderer renderer{};
+        ASSERT_EQ("sv_cheats", renderer.update("sv_cheats", 9));
+        ASSERT_EQ("\b", renderer.update("sv_cheats", 8));
+        ASSERT_EQ("\x1B[8D", renderer.update("sv_cheats", 0));
+        ASSERT_EQ("\x1B[9C", renderer.update("sv_cheats", 9));
+    }
+
+    TEST(LineRenderer, InsertInTheMiddle)
+    {
+        LineRenderer renderer{};
+        ASSERT_EQ("mp", renderer.update("mp", 2));
+        ASSERT_EQ("\b", renderer.update("mp", 1));
+        ASSERT_EQ("ap\b", renderer.update("map", 2));
+    }
+
+    TEST(LineRenderer, Backspace)
+    {
+        LineRenderer renderer{};
+        ASSERT_EQ("maps", renderer.update("maps", 4));
+        ASSERT_EQ("\b\x1B[K", renderer.update("map", 3));
+        ASSERT_EQ("\x1B[3D\x1B[K", renderer.update("", 0));
+    }
+
+    TEST(LineRenderer, HistoryRecall)
+    {
+        LineRenderer renderer{};
+        ASSERT_EQ("status", renderer.update("status", 6));
+        ASSERT_EQ("\x1B[6Dmaxplayers 32", renderer.update("maxplayers 32", 13));
+        ASSERT_EQ("\x1B[13Dstats\x1B[K", renderer.update("stats", 5));
+
+        renderer.reset();
+        ASSERT_EQ("quit", renderer.update("quit", 4));
+    }
+}
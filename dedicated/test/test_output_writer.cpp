@@ -0,0 +1,100 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "../src/console/output_writer.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace rehlds::dedicated::test
+{
+    /* Text written by the output writer threads. */
+    struct CapturedOutput
+    {
+        std::string text{};
+        std::mutex mutex{};
+
+        [[nodiscard]] std::string get()
+        {
+            const std::lock_guard lock{mutex};
+            return text;
+        }
+    };
+
+    class CaptureSink final : public OutputSink
+    {
+      public:
+        explicit CaptureSink(CapturedOutput& output) : output_(output) {}
+
+        void write(const OutputSegments& segments) override
+        {
+            const std::lock_guard lock{output_.mutex};
+
+            for (const auto segment : segments) {
+                output_.text.append(segment);
+            }
+        }
+
+      private:
+        CapturedOutput& output_;
+    };
+
+    TEST(OutputWriter, WritesInOrder)
+    {
+        CapturedOutput output{};
+        OutputWriter writer{};
+        writer.start(std::make_unique<CaptureSink>(output), 64);
+        ASSERT_TRUE(writer.started());
+
+        std::string expected{};
+
+        // Small capacity makes the ring buffer wrap around many times
+        for (auto i = 0; i < 1000; ++i) {
+            const auto line = std::to_string(i) + '\n';
+
+            while (!writer.write(line)) {}
+
+            expected += line;
+        }
+
+        writer.stop();
+        ASSERT_FALSE(writer.started());
+
+        // Retried lines are reported as dropped, skip the notices
+        std::string text{};
+        std::string::size_type start = 0;
+        const auto captured = output.get();
+
+        while (start < captured.length()) {
+            const auto end = captured.find('\n', start) + 1;
+
+            if (0 != captured.compare(start, 8, "WARNING!")) {
+                text.append(captured, start, end - start);
+            }
+
+            start = end;
+        }
+
+        ASSERT_EQ(expected, text);
+    }
+
+    TEST(OutputWriter, DropsOnOverflow)
+    {
+        CapturedOutput output{};
+        OutputWriter writer{};
+        writer.start(std::make_unique<CaptureSink>(output), 16);
+
+        ASSERT_FALSE(writer.write(std::string(17, 'x')));
+        ASSERT_EQ(1, writer.dropped_messages());
+        ASSERT_EQ(17, writer.dropped_bytes());
+
+        ASSERT_TRUE(writer.write("text\n"));
+        writer.stop();
+
+        const auto text = output.get();
+        ASSERT_NE(std::string::npos, text.find("1 messages dropped"));
+        ASSERT_NE(std::string::npos, text.find("text\n"));
+    }
+}
@@ -0,0 +1,153 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+#include "../src/pool_allocator.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace rehlds::dedicated::test
+{
+    namespace
+    {
+        constexpr std::size_t POOL_SIZE = 16 * 1024 * 1024;
+
+        [[nodiscard]] PoolAllocator& enabled_pool()
+        {
+            auto& pool = get_pool_allocator();
+            pool.enable(POOL_SIZE);
+
+            // The blocks cached by the previous tests would count as used
+            pool.flush_thread_cache();
+
+            return pool;
+        }
+    }
+
+    TEST(PoolAllocator, SizeClasses)
+    {
+        ASSERT_EQ(POOL_MAX_BLOCK_SIZE, pool_block_size(POOL_SIZE_CLASSES - 1));
+        ASSERT_EQ(0, pool_size_class(0));
+        ASSERT_EQ(POOL_SIZE_CLASSES - 1, pool_size_class(POOL_MAX_BLOCK_SIZE));
+
+        for (std::size_t size = 1; size <= POOL_MAX_BLOCK_SIZE; ++size) {
+            const auto size_class = pool_size_class(size);
+            ASSERT_GE(pool_block_size(size_class), size);
+            ASSERT_TRUE((0 == size_class) || (pool_block_size(size_class - 1) < size));
+            ASSERT_EQ(0, pool_block_size(size_class) % POOL_ALIGNMENT);
+        }
+    }
+
+    TEST(PoolAllocator, AllocateAndFree)
+    {
+        auto& pool = enabled_pool();
+        ASSERT_TRUE(pool.enabled());
+        ASSERT_EQ(nullptr, pool.allocate(POOL_MAX_BLOCK_SIZE + 1));
+
+        std::vector<void*> blocks{};
+
+        for (std::size_t size = 1; size <= POOL_MAX_BLOCK_SIZE; size = size * 3 / 2 + 1) {
+            auto* const block = pool.allocate(size);
+            ASSERT_NE(nullptr, block);
+            ASSERT_TRUE(pool.owns(block));
+            ASSERT_GE(pool.block_size(block), size);
+            ASSERT_EQ(0, reinterpret_cast<std::uintptr_t>(block) % POOL_ALIGNMENT);
+
+            std::memset(block, 0xAB, size);
+            blocks.push_back(block);
+        }
+
+        for (auto* const block : blocks) {
+            pool.deallocate(block);
+        }
+
+        ASSERT_FALSE(pool.owns(&blocks));
+    }
+
+    TEST(PoolAllocator, ReusesFreedBlocks)
+    {
+        auto& pool = enabled_pool();
+        auto* const first = pool.allocate(100);
+        pool.deallocate(first);
+
+        ASSERT_EQ(first, pool.allocate(100));
+        pool.deallocate(first);
+    }
+
+    TEST(PoolAllocator, CrossThreadFreeAndTrim)
+    {
+        auto& pool = enabled_pool();
+        constexpr std::size_t count = 20000;
+        std::vector<void*> blocks(count);
+
+        std::thread{[&pool, &blocks]
+          {
+              for (auto& block : blocks) {
+                  block = pool.allocate(48);
+              }
+          }}.join();
+
+        for (auto* const block : blocks) {
+            ASSERT_NE(nullptr, block);
+            pool.deallocate(block);
+        }
+
+        ASSERT_GT(pool.trim(), 0);
+
+        const auto stats = pool.stats();
+        ASSERT_EQ(0, stats.classes[pool_size_class(48)].used_blocks);
+        ASSERT_EQ(0, stats.classes[pool_size_class(48)].spans);
+        ASSERT_GT(stats.released_bytes, 0);
+        ASSERT_GT(stats.free_spans, 0);
+    }
+
+    TEST(PoolAllocator, ConcurrentThreads)
+    {
+        auto& pool = enabled_pool();
+        std::vector<std::thread> threads{};
+
+        for (std::size_t thread = 0; thread < 4; ++thread) {
+            threads.emplace_back(
+              [&pool, thread]
+              {
+                  std::vector<unsigned char*> blocks{};
+
+                  for (std::size_t i = 0; i < 50000; ++i) {
+                      const auto size = ((i * 7919) % 2048) + 1;
+                      auto* const block = static_cast<unsigned char*>(pool.allocate(size));
+                      ASSERT_NE(nullptr, block);
+                      block[0] = static_cast<unsigned char>(thread);
+                      block[size - 1] = static_cast<unsigned char>(thread);
+                      blocks.push_back(block);
+
+                      if (blocks.size() > 512) {
+                          ASSERT_EQ(thread, blocks.front()[0]);
+                          pool.deallocate(blocks.front());
+                          blocks.erase(blocks.begin());
+                      }
+                  }
+
+                  for (auto* const block : blocks) {
+                      ASSERT_EQ(thread, block[0]);
+                      pool.deallocate(block);
+                  }
+              });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        const auto stats = pool.stats();
+
+        for (const auto& size_class : stats.classes) {
+            ASSERT_EQ(0, size_class.used_blocks);
+        }
+
+        ASSERT_EQ(0, stats.exhausted_allocations);
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ *  ========== Copyright (c) Valve Corporation. All rights reserved. ==========
+ */
+
+// Prints the status pages published by the servers started with -statuspage.
+// Usage: hlds_status [name...]; without names, all pages in /dev/shm are listed.
+// The servers idling under -idlesleep are marked with an asterisk.
+
+#include "status_page.h"
+#include "cpputils/format.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace rehlds::dedicated;
+
+namespace
+{
+    [[nodiscard]] double milliseconds(const std::uint64_t nanoseconds)
+    {
+        return static_cast<double>(nanoseconds) / 1'000'000.0;
+    }
+
+    [[nodiscard]] std::vector<std::string> find_pages()
+    {
+        std::vector<std::string> names{};
+        std::error_code error{};
+
+        for (const auto& entry : std::filesystem::directory_iterator{"/dev/shm", error}) {
+            if (auto name = entry.path().filename().string(); 0 == name.rfind(STATUS_PAGE_PREFIX, 0)) {
+                names.push_back(std::move(name));
+            }
+        }
+
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    enum class ReadResult
+    {
+        ok,
+        failed,
+        not_ready, /* The publisher has not sized the object yet, or it is stale. */
+    };
+
+    [[nodiscard]] ReadResult read_page(const std::string& name, StatusData& data)
+    {
+        const auto descriptor = ::shm_open(('/' + name).c_str(), O_RDONLY | O_CLOEXEC, 0);
+
+        if (descriptor < 0) {
+            return ReadResult::failed;
+        }
+
+        struct stat status{};
+
+        // Reading past the end of a shorter object raises SIGBUS
+        if ((0 != ::fstat(descriptor, &status)) || (static_cast<std::size_t>(status.st_size) < sizeof(StatusPage))) {
+            ::close(descriptor);
+            return ReadResult::not_ready;
+        }
+
+        auto* const memory = ::mmap(nullptr, sizeof(StatusPage), PROT_READ, MAP_SHARED, descriptor, 0);
+        ::close(descriptor);
+
+        if (MAP_FAILED == memory) {
+            return ReadResult::failed;
+        }
+
+        const auto result = read_status_page(*static_cast<const StatusPage*>(memory), data);
+        ::munmap(memory, sizeof(StatusPage));
+
+        return result ? ReadResult::ok : ReadResult::failed;
+    }
+
+    void print_page(const std::string& name, const StatusData& data)
+    {
+        const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+
+        const auto age = static_cast<double>(now - data.update_time) / 1e9;
+        const auto uptime = static_cast<double>(data.update_time - data.start_time) / 1e9;
+        const auto cpu = static_cast<double>(data.user_time + data.system_time) / 1e9;
+        const auto idle = static_cast<double>(data.idle_time) / 1e9;
+        const auto saved = static_cast<double>(data.idle_saved_cpu_time) / 1e9;
+
+        cpputils::print("{:<16}{:>8}{:>7}/{:<3}{:<16}{:>8.1f}{:>9.2f}{:>9.2f}{:>9.2f}{:>10.0f}{:>9.1f}{:>8.1f}{:>9}"
+                        "{:>9.0f}{:>9.1f}{}\n",
+          name, data.pid, data.active_players, data.max_players, data.map, data.fps, milliseconds(data.frame_p50),
+          milliseconds(data.frame_p99), milliseconds(data.frame_max), uptime, cpu, age, data.output_dropped, idle,
+          saved, 0 == data.idle ? "" : " *");
+    }
+}
+
+int main(const int argc, char* argv[])
+{
+    std::vector<std::string> names(argv + 1, argv + argc);
+
+    if (names.empty()) {
+        names = find_pages();
+    }
+
+    cpputils::print("{:<16}{:>8}{:>11}{:<16}{:>8}{:>9}{:>9}{:>9}{:>10}{:>9}{:>8}{:>9}{:>9}{:>9}\n", "name", "pid",
+      "players ", "map", "fps", "p50 ms", "p99 ms", "max ms", "uptime s", "cpu s", "age s", "dropped", "idle s",
+      "saved s");
+
+    auto result = EXIT_SUCCESS;
+
+    for (const auto& name : names) {
+        StatusData data{};
+
+        switch (read_page(name, data)) {
+            case ReadResult::ok:
+                print_page(name, data);
+                break;
+
+            case ReadResult::not_ready:
+                cpputils::print(stderr, "{}: the status page is not ready.\n", name);
+                result = EXIT_FAILURE;
+                break;
+
+            case ReadResult::failed:
+                cpputils::print(stderr, "{}: unable to read the status page.\n", name);
+                result = EXIT_FAILURE;
+                break;
+        }
+    }
+
+    return result;
+}
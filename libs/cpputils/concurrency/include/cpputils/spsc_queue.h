@@ -0,0 +1,147 @@
+/*
+ *  Copyright (C) 2023 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace cpputils
+{
+    /**
+     * @brief Bounded lock-free queue with a single producer thread and a single consumer thread.
+     *
+     * Both \c try_push() and \c try_pop() are wait-free: each side owns one index, publishes it
+     * with a release store, and caches the other side's index so that the shared cache line is
+     * only read when the cached value says the queue is full (or empty).
+     *
+     * @tparam T Element type; must be default constructible and move assignable.
+     * @tparam Capacity Maximum number of elements; must be a power of two.
+     */
+    template <typename T, std::size_t Capacity>
+    class SpscQueue
+    {
+        static_assert((Capacity >= 2) && (0 == (Capacity & (Capacity - 1))), "Capacity must be a power of two.");
+        static_assert(std::is_default_constructible_v<T>, "T must be default constructible.");
+        static_assert(std::is_move_assignable_v<T>, "T must be move assignable.");
+
+      public:
+        SpscQueue() = default;
+        SpscQueue(SpscQueue&&) = delete;
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(SpscQueue&&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+        ~SpscQueue() = default;
+
+        /**
+         * @brief Appends an element to the queue. Must be called by the producer thread only.
+         *
+         * @return \c true if the element was added, \c false if the queue is full.
+         */
+        template <typename U>
+        bool try_push(U&& value)
+        {
+            const auto tail = tail_.load(std::memory_order_relaxed);
+
+            if (tail - head_cache_ == Capacity) {
+                head_cache_ = head_.load(std::memory_order_acquire);
+
+                if (tail - head_cache_ == Capacity) {
+                    return false;
+                }
+            }
+
+            buffer_[tail & MASK] = std::forward<U>(value);
+            tail_.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        /**
+         * @brief Removes the oldest element from the queue. Must be called by the consumer thread only.
+         *
+         * @return \c true if an element was moved to \p value, \c false if the queue is empty.
+         */
+        bool try_pop(T& value)
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+
+            if (head == tail_cache_) {
+                tail_cache_ = tail_.load(std::memory_order_acquire);
+
+                if (head == tail_cache_) {
+                    return false;
+                }
+            }
+
+            value = std::move(buffer_[head & MASK]);
+            head_.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        /**
+         * @brief Returns true if the queue is empty. The result is a snapshot and may be stale.
+         */
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Returns the number of elements in the queue. The result is a snapshot and may be stale.
+         */
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            const auto head = head_.load(std::memory_order_acquire);
+            return tail_.load(std::memory_order_acquire) - head;
+        }
+
+        /**
+         * @brief Returns the maximum number of elements in the queue.
+         */
+        [[nodiscard]] static constexpr std::size_t capacity() noexcept
+        {
+            return Capacity;
+        }
+
+      private:
+        /* Size of a cache line, used to keep the producer and consumer indices apart. */
+        static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+        /* Mask that maps a free-running index to a buffer slot. */
+        static constexpr std::size_t MASK = Capacity - 1;
+
+        /* Index of the next element to pop, written by the consumer. */
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_{};
+
+        /* Consumer's copy of the producer index. */
+        std::size_t tail_cache_{};
+
+        /* Index of the next slot to push, written by the producer. */
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_{};
+
+        /* Producer's copy of the consumer index. */
+        std::size_t head_cache_{};
+
+        /* Ring buffer storage. */
+        alignas(CACHE_LINE_SIZE) std::array<T, Capacity> buffer_{};
+    };
+}
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (C) 2023 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cpputils/spsc_queue.h"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace cpputils::test
+{
+    TEST(SpscQueue, PushPop)
+    {
+        SpscQueue<std::string, 4> queue{};
+        std::string value{};
+
+        ASSERT_TRUE(queue.empty());
+        ASSERT_FALSE(queue.try_pop(value));
+
+        ASSERT_TRUE(queue.try_push("first"));
+        ASSERT_TRUE(queue.try_push(std::string{"second"}));
+        ASSERT_EQ(2, queue.size());
+        ASSERT_FALSE(queue.empty());
+
+        ASSERT_TRUE(queue.try_pop(value));
+        ASSERT_EQ("first", value);
+        ASSERT_TRUE(queue.try_pop(value));
+        ASSERT_EQ("second", value);
+        ASSERT_FALSE(queue.try_pop(value));
+        ASSERT_TRUE(queue.empty());
+    }
+
+    TEST(SpscQueue, Full)
+    {
+        SpscQueue<int, 4> queue{};
+        int value{};
+
+        for (auto i = 0; i < 4; ++i) {
+            ASSERT_TRUE(queue.try_push(i));
+        }
+
+        ASSERT_FALSE(queue.try_push(4));
+        ASSERT_EQ(queue.capacity(), queue.size());
+
+        // The freed slot is reused after wrapping around
+        ASSERT_TRUE(queue.try_pop(value));
+        ASSERT_EQ(0, value);
+        ASSERT_TRUE(queue.try_push(4));
+
+        for (auto i = 1; i <= 4; ++i) {
+            ASSERT_TRUE(queue.try_pop(value));
+            ASSERT_EQ(i, value);
+        }
+    }
+
+    TEST(SpscQueue, ProducerConsumer)
+    {
+        constexpr std::uint32_t count = 200'000;
+        SpscQueue<std::uint32_t, 64> queue{};
+
+        std::thread producer{[&queue] {
+            for (std::uint32_t i = 0; i < count; ++i) {
+                while (!queue.try_push(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        }};
+
+        std::uint32_t expected = 0;
+        std::uint32_t value = 0;
+        std::uint32_t reordered = 0;
+
+        while (expected < count) {
+            if (queue.try_pop(value)) {
+                reordered += (expected == value) ? 0U : 1U;
+                ++expected;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+
+        producer.join();
+        ASSERT_EQ(0, reordered);
+        ASSERT_TRUE(queue.empty());
+    }
+}
@@ -18,8 +18,11 @@
 #pragma once
 
 #include <fmt/core.h>
+#include <fmt/format.h>
 #include <cstdio>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <utility>
 
 namespace cpputils
@@ -30,6 +33,14 @@ namespace cpputils
         return fmt::format(std::move(format), std::forward<Args>(args)...);
     }
 
+    using MemoryBuffer = fmt::memory_buffer;
+
+    template <typename... Args>
+    void format_to(MemoryBuffer& buffer, const std::string_view format, Args&&... args)
+    {
+        fmt::vformat_to(std::back_inserter(buffer), format, fmt::make_format_args(args...));
+    }
+
     template <typename... Args>
     void print(std::string format, Args&&... args)
     {
@@ -102,6 +102,32 @@ namespace cpputils
         }
     }
 
+    /**
+     * @brief Loads the specified module into a link-map namespace, so it gets its own copy
+     * of the global data of the module and of its dependencies.
+     *
+     * @param link_map Namespace to load the module into. \c LM_ID_NEWLM creates a new namespace;
+     * its identifier is stored back, so the next modules can be loaded into the same namespace.
+     */
+    template <typename Ret = class SysModule*>
+    [[nodiscard]] Ret load_module(const char* const filename, ::Lmid_t& link_map, const int mode = RTLD_NOW)
+    {
+        const auto& absolute_path = get_module_absolute_path(filename);
+        auto* const module = ::dlmopen(link_map, absolute_path.c_str(), mode);
+
+        if ((nullptr != module) && (LM_ID_NEWLM == link_map) && (0 != ::dlinfo(module, RTLD_DI_LMID, &link_map))) {
+            link_map = LM_ID_NEWLM;
+        }
+
+        if constexpr (std::is_same_v<Ret, void*>) {
+            return module;
+        }
+        else {
+            // NOLINTNEXTLINE(clang-diagnostic-cast-function-type)
+            return reinterpret_cast<Ret>(module);
+        }
+    }
+
     /**
      * @brief Frees the loaded module and, if necessary, decrements its reference count.
      * When the reference count reaches zero, the module is unloaded from the address space
@@ -0,0 +1,196 @@
+/*
+ *  Copyright (C) 2023 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "cpputils/singleton_holder.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cpputils
+{
+    /**
+     * @brief Completed span recorded by the tracer.
+     */
+    struct TraceEvent
+    {
+        /* Span name. */
+        std::string name{};
+
+        /* Span category. */
+        std::string category{};
+
+        /* Optional detail, e.g. a module or an interface name. */
+        std::string detail{};
+
+        /* Start time relative to the tracer start, in microseconds. */
+        std::int64_t start{};
+
+        /* Span duration, in microseconds. */
+        std::int64_t duration{};
+
+        /* Sequential number of the recording thread. */
+        std::uint32_t thread{};
+    };
+
+    /**
+     * @brief Collects timed spans and writes them as a Chrome/Perfetto \c trace_event JSON file.
+     *
+     * Recording is thread-safe. While the tracer is stopped, a span costs a single relaxed load.
+     * The events are kept in memory and written out by \c stop(), so the tracer is meant for
+     * bounded phases such as the startup, not for the steady state.
+     */
+    class Tracer
+    {
+      public:
+        /**
+         * @brief Starts recording; the trace is written to the specified file by \c stop().
+         */
+        void start(std::string path);
+
+        /**
+         * @brief Stops recording and writes the recorded events.
+         *
+         * @return \c true if the trace file was written, otherwise \c false
+         */
+        bool stop();
+
+        /**
+         * @brief Returns true if the spans are recorded.
+         */
+        [[nodiscard]] bool enabled() const noexcept;
+
+        /**
+         * @brief Returns the current time relative to the tracer start, in microseconds.
+         */
+        [[nodiscard]] std::int64_t now() const noexcept;
+
+        /**
+         * @brief Records a completed span.
+         */
+        void record(std::string_view name, std::string_view category, std::string_view detail, std::int64_t start);
+
+        /**
+         * @brief Returns a copy of the recorded events.
+         */
+        [[nodiscard]] std::vector<TraceEvent> events() const;
+
+        /**
+         * @brief Formats the events as a \c trace_event JSON document.
+         */
+        [[nodiscard]] static std::string to_json(const std::vector<TraceEvent>& events);
+
+      private:
+        /* Is the tracer recording? */
+        std::atomic<bool> enabled_{};
+
+        /* Trace file path. */
+        std::string path_{};
+
+        /* Tracer start time on the steady clock, in nanoseconds; read by now() without the lock. */
+        std::atomic<std::int64_t> start_time_{};
+
+        /* Recorded events. */
+        std::vector<TraceEvent> events_{};
+
+        /* Protects the recorded events. */
+        mutable std::mutex mutex_{};
+    };
+
+    inline bool Tracer::enabled() const noexcept
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    inline std::int64_t Tracer::now() const noexcept
+    {
+        const std::chrono::nanoseconds start{start_time_.load(std::memory_order_relaxed)};
+        const auto elapsed = std::chrono::steady_clock::now().time_since_epoch() - start;
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    }
+
+    /**
+     * @brief Returns the tracer instance.
+     */
+    [[nodiscard]] inline Tracer& get_tracer()
+    {
+        return SingletonHolder<Tracer>::get_instance();
+    }
+
+    /**
+     * @brief Records the lifetime of the object as a span, if the tracer is enabled when the span starts.
+     *
+     * The name, category and detail are not copied until the span ends, so they must outlive the span.
+     */
+    class TraceSpan
+    {
+      public:
+        /**
+         * @brief Starts a span.
+         *
+         * @param name Span name.
+         * @param category Span category, e.g. "launcher" or "module".
+         * @param detail Optional detail shown in the span arguments.
+         */
+        explicit TraceSpan(std::string_view name, std::string_view category = "launcher", std::string_view detail = {});
+
+        TraceSpan(TraceSpan&&) = delete;
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(TraceSpan&&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+        /**
+         * @brief Ends the span.
+         */
+        ~TraceSpan();
+
+      private:
+        /* Span name. */
+        std::string_view name_;
+
+        /* Span category. */
+        std::string_view category_;
+
+        /* Span detail. */
+        std::string_view detail_;
+
+        /* Start time, or -1 if the tracer was disabled. */
+        std::int64_t start_{-1};
+    };
+
+    inline TraceSpan::TraceSpan(const std::string_view name, const std::string_view category,
+      const std::string_view detail)
+      : name_(name), category_(category), detail_(detail)
+    {
+        if (auto& tracer = get_tracer(); tracer.enabled()) {
+            start_ = tracer.now();
+        }
+    }
+
+    inline TraceSpan::~TraceSpan()
+    {
+        if (start_ >= 0) {
+            get_tracer().record(name_, category_, detail_, start_);
+        }
+    }
+}
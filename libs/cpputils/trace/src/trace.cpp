@@ -0,0 +1,144 @@
+/*
+ *  Copyright (C) 2023 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cpputils/trace.h"
+#include "cpputils/format.h"
+#include <cstdio>
+#include <memory>
+#include <utility>
+
+namespace
+{
+    /* Source of the sequential thread numbers. */
+    std::atomic<std::uint32_t> next_thread{};
+
+    /* Sequential number of the calling thread; the trace viewer groups the spans by it. */
+    [[nodiscard]] std::uint32_t thread_number()
+    {
+        thread_local const auto number = next_thread.fetch_add(1, std::memory_order_relaxed) + 1;
+        return number;
+    }
+
+    void append_escaped(cpputils::MemoryBuffer& buffer, const std::string_view text)
+    {
+        for (const auto character : text) {
+            switch (character) {
+                case '"':
+                    buffer.append(std::string_view{"\\\""});
+                    break;
+
+                case '\\':
+                    buffer.append(std::string_view{"\\\\"});
+                    break;
+
+                case '\n':
+                    buffer.append(std::string_view{"\\n"});
+                    break;
+
+                case '\t':
+                    buffer.append(std::string_view{"\\t"});
+                    break;
+
+                default:
+                    if (static_cast<unsigned char>(character) < 0x20) {
+                        cpputils::format_to(buffer, "\\u{:04x}", static_cast<unsigned>(character));
+                    }
+                    else {
+                        buffer.push_back(character);
+                    }
+            }
+        }
+    }
+}
+
+namespace cpputils
+{
+    void Tracer::start(std::string path)
+    {
+        const std::lock_guard lock{mutex_};
+        path_ = std::move(path);
+        events_.clear();
+        const auto start = std::chrono::steady_clock::now().time_since_epoch();
+        const auto start_time = std::chrono::duration_cast<std::chrono::nanoseconds>(start).count();
+        start_time_.store(start_time, std::memory_order_relaxed);
+        enabled_.store(true, std::memory_order_release);
+    }
+
+    bool Tracer::stop()
+    {
+        if (!enabled_.exchange(false, std::memory_order_acq_rel)) {
+            return false;
+        }
+
+        const auto json = to_json(events());
+        const std::unique_ptr<std::FILE, decltype(&std::fclose)> file{std::fopen(path_.c_str(), "wb"), &std::fclose};
+
+        if (!file) {
+            return false;
+        }
+
+        return json.size() == std::fwrite(json.data(), 1, json.size(), file.get());
+    }
+
+    void Tracer::record(const std::string_view name, const std::string_view category, const std::string_view detail,
+      const std::int64_t start)
+    {
+        const auto duration = now() - start;
+        const auto thread = thread_number();
+
+        const std::lock_guard lock{mutex_};
+
+        if (enabled_.load(std::memory_order_relaxed)) {
+            events_.push_back({std::string{name}, std::string{category}, std::string{detail}, start, duration, thread});
+        }
+    }
+
+    std::vector<TraceEvent> Tracer::events() const
+    {
+        const std::lock_guard lock{mutex_};
+        return events_;
+    }
+
+    std::string Tracer::to_json(const std::vector<TraceEvent>& events)
+    {
+        MemoryBuffer buffer{};
+        buffer.append(std::string_view{"{\"traceEvents\":["});
+
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            const auto& event = events[i];
+            buffer.append(std::string_view{0 == i ? "\n{\"name\":\"" : ",\n{\"name\":\""});
+            append_escaped(buffer, event.name);
+            buffer.append(std::string_view{"\",\"cat\":\""});
+            append_escaped(buffer, event.category);
+
+            format_to(buffer, R"(","ph":"X","ts":{},"dur":{},"pid":1,"tid":{})", event.start,
+              event.duration, event.thread);
+
+            if (!event.detail.empty()) {
+                buffer.append(std::string_view{",\"args\":{\"detail\":\""});
+                append_escaped(buffer, event.detail);
+                buffer.append(std::string_view{"\"}"});
+            }
+
+            buffer.push_back('}');
+        }
+
+        buffer.append(std::string_view{"\n],\"displayTimeUnit\":\"ms\"}\n"});
+
+        return {buffer.data(), buffer.size()};
+    }
+}
@@ -0,0 +1,135 @@
+/*
+ *  Copyright (C) 2023 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cpputils/trace.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cpputils::test
+{
+    namespace
+    {
+        [[nodiscard]] std::string trace_path()
+        {
+            return (std::filesystem::temp_directory_path() / "cpputils_test_trace.json").string();
+        }
+
+        void stop_tracer()
+        {
+            get_tracer().stop();
+            std::filesystem::remove(trace_path());
+        }
+    }
+
+    TEST(Tracer, DisabledSpansAreNotRecorded)
+    {
+        auto& tracer = get_tracer();
+        ASSERT_FALSE(tracer.enabled());
+
+        {
+            const TraceSpan span{"disabled"};
+        }
+
+        tracer.start(trace_path());
+        stop_tracer();
+        ASSERT_TRUE(tracer.events().empty());
+    }
+
+    TEST(Tracer, RecordsNestedSpans)
+    {
+        auto& tracer = get_tracer();
+        tracer.start(trace_path());
+
+        {
+            const TraceSpan outer{"outer", "test"};
+            const TraceSpan inner{"inner", "test", "detail"};
+        }
+
+        const auto events = tracer.events();
+        stop_tracer();
+
+        ASSERT_EQ(2, events.size());
+        ASSERT_EQ("inner", events[0].name);
+        ASSERT_EQ("detail", events[0].detail);
+        ASSERT_EQ("outer", events[1].name);
+        ASSERT_EQ("test", events[1].category);
+        ASSERT_LE(events[1].start, events[0].start);
+        ASSERT_GE(events[1].start + events[1].duration, events[0].start + events[0].duration);
+        ASSERT_EQ(events[0].thread, events[1].thread);
+    }
+
+    TEST(Tracer, NumbersThreads)
+    {
+        auto& tracer = get_tracer();
+        tracer.start(trace_path());
+
+        {
+            const TraceSpan span{"main"};
+            std::thread{[] { const TraceSpan worker{"worker"}; }}.join();
+        }
+
+        const auto events = tracer.events();
+        stop_tracer();
+
+        ASSERT_EQ(2, events.size());
+        ASSERT_NE(events[0].thread, events[1].thread);
+    }
+
+    TEST(Tracer, WritesFile)
+    {
+        auto& tracer = get_tracer();
+        const auto path = trace_path();
+        tracer.start(path);
+
+        {
+            const TraceSpan span{"span"};
+        }
+
+        ASSERT_TRUE(tracer.stop());
+        ASSERT_FALSE(tracer.stop());
+
+        std::ifstream file{path};
+        const std::string json{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+        file.close();
+        std::filesystem::remove(path);
+
+        ASSERT_EQ(0, json.find("{\"traceEvents\":[\n{\"name\":\"span\",\"cat\":\"launcher\",\"ph\":\"X\""));
+    }
+
+    TEST(Tracer, FormatsJson)
+    {
+        const std::vector<TraceEvent> events{
+          {"load \"engine\"", "module", "C:\\hlds\n", 10, 20, 1},
+          {"run", "launcher", "", 40, 5, 2}
+        };
+
+        ASSERT_EQ("{\"traceEvents\":[\n"
+                  R"({"name":"load \"engine\"","cat":"module","ph":"X","ts":10,"dur":20,"pid":1,"tid":1,)"
+                  R"("args":{"detail":"C:\\hlds\n"}},)"
+                  "\n"
+                  R"({"name":"run","cat":"launcher","ph":"X","ts":40,"dur":5,"pid":1,"tid":2})"
+                  "\n],\"displayTimeUnit\":\"ms\"}\n",
+          Tracer::to_json(events));
+
+        ASSERT_EQ("{\"traceEvents\":[\n],\"displayTimeUnit\":\"ms\"}\n", Tracer::to_json({}));
+    }
+}